@@ -257,10 +257,20 @@ workspace "XCSG"
 
 		-- 'files' paths are relative to premake file
 		files {
-			"csg_parser/cf_xmlNode.cpp"
+			"csg_parser/cf_xmlBinary.cpp"
+			,"csg_parser/cf_xmlBinary.h"
+			,"csg_parser/cf_xmlJson.cpp"
+			,"csg_parser/cf_xmlJson.h"
+			,"csg_parser/cf_xmlNode.cpp"
 			,"csg_parser/cf_xmlNode.h"
+			,"csg_parser/cf_xmlPayload.cpp"
+			,"csg_parser/cf_xmlPayload.h"
+			,"csg_parser/cf_xmlPullParser.cpp"
+			,"csg_parser/cf_xmlPullParser.h"
 			,"csg_parser/cf_xmlTree.cpp"
 			,"csg_parser/cf_xmlTree.h"
+			,"csg_parser/csg_array.cpp"
+			,"csg_parser/csg_array.h"
 			,"csg_parser/csg_matrix.cpp"
 			,"csg_parser/csg_matrix.h"
 			,"csg_parser/csg_node.cpp"
@@ -307,6 +317,8 @@ workspace "XCSG"
 			,"xcsg/boolean_timer.h"
 			,"xcsg/boost_command_line.cpp"
 			,"xcsg/boost_command_line.h"
+			,"xcsg/cancel_token.cpp"
+			,"xcsg/cancel_token.h"
 			,"xcsg/carve_boolean.cpp"
 			,"xcsg/carve_boolean.h"
 			,"xcsg/carve_boolean_thread.cpp"
@@ -343,19 +355,30 @@ workspace "XCSG"
 			,"xcsg/clipper_csg/tmesh_adapter.h"
 			,"xcsg/clipper_csg/vmap2d.cpp"
 			,"xcsg/clipper_csg/vmap2d.h"
+			,"xcsg/convex_polygon.cpp"
+			,"xcsg/convex_polygon.h"
 			,"xcsg/dxf_file.cpp"
 			,"xcsg/dxf_file.h"
 			,"xcsg/extrude_mesh.cpp"
 			,"xcsg/extrude_mesh.h"
+			,"xcsg/flat_key_map.h"
 			,"xcsg/geodesic_sphere.cpp"
 			,"xcsg/geodesic_sphere.h"
+			,"xcsg/lump_mesh.cpp"
+			,"xcsg/lump_mesh.h"
 			,"xcsg/main.cpp"
+			,"xcsg/mesh_stats.cpp"
+			,"xcsg/mesh_stats.h"
 			,"xcsg/mesh_utils.cpp"
 			,"xcsg/mesh_utils.h"
+			,"xcsg/mesh_validator.cpp"
+			,"xcsg/mesh_validator.h"
 			,"xcsg/openscad_csg.cpp"
 			,"xcsg/openscad_csg.h"
 			,"xcsg/out_triangles.cpp"
 			,"xcsg/out_triangles.h"
+			,"xcsg/perf_counters.cpp"
+			,"xcsg/perf_counters.h"
 			,"xcsg/polymesh3d.cpp"
 			,"xcsg/polymesh3d.h"
 			,"xcsg/primitives2d.cpp"
@@ -364,6 +387,7 @@ workspace "XCSG"
 			,"xcsg/primitives3d.h"
 			,"xcsg/project_mesh.cpp"
 			,"xcsg/project_mesh.h"
+			,"xcsg/run_concurrently.h"
 			,"xcsg/safe_queue.h"
 			,"xcsg/std_filename.cpp"
 			,"xcsg/std_filename.h"
@@ -381,6 +405,8 @@ workspace "XCSG"
 			,"xcsg/sweep_path_spline.h"
 			,"xcsg/sweep_path_transform.cpp"
 			,"xcsg/sweep_path_transform.h"
+			,"xcsg/text_buffer.cpp"
+			,"xcsg/text_buffer.h"
 			,"xcsg/tin_mesh.cpp"
 			,"xcsg/tin_mesh.h"
 			,"xcsg/version.h"
@@ -392,6 +418,8 @@ workspace "XCSG"
 			,"xcsg/xcsg_factory.h"
 			,"xcsg/xcsg_main.cpp"
 			,"xcsg/xcsg_main.h"
+			,"xcsg/xcsg_status.cpp"
+			,"xcsg/xcsg_status.h"
 			,"xcsg/xcube.cpp"
 			,"xcsg/xcube.h"
 			,"xcsg/xcuboid.cpp"
@@ -460,6 +488,8 @@ workspace "XCSG"
 			,"xcsg/xunion2d.h"
 			,"xcsg/xunion3d.cpp"
 			,"xcsg/xunion3d.h"
+			,"xcsg/zip_streambuf.cpp"
+			,"xcsg/zip_streambuf.h"
 			}
 
 		filter { "configurations:debug" }
@@ -467,6 +497,7 @@ workspace "XCSG"
 			kind ( "ConsoleApp" ) 
 			-- When linking within workspace, 'links' refer to project name.
 			links { "carve","csg_parser","csplines","dmesh","qhull","tmesh" } 
+			links { iif(os.istarget("windows"),"zlib","z") } 
 			symbols  ( "on" ) 
 		filter { }
 
@@ -475,5 +506,227 @@ workspace "XCSG"
 			kind ( "ConsoleApp" ) 
 			-- When linking within workspace, 'links' refer to project name.
 			links { "carve","csg_parser","csplines","dmesh","qhull","tmesh" } 
+			links { iif(os.istarget("windows"),"zlib","z") } 
+			optimize  ( "on" ) 
+		filter { }
+
+	project "xcsg_bench"
+		location "buildpm5/xcsg_bench"
+		architecture  ( "x86_64" ) 
+		cppdialect  ( "c++17" ) 
+		dependson { "csg_parser","csplines","dmesh","qhull","tmesh" } 
+		exceptionhandling  ( "on" ) 
+		includedirs { ".","csg_parser","csplines","dmesh","qhull","tmesh","xcsg","xcsg_bench" } 
+		language  ( "c++" ) 
+		pic  ( "on" ) 
+		rtti  ( "on" ) 
+		staticruntime  ( "off" ) 
+
+		-- 'files' paths are relative to premake file
+		files {
+			"xcsg/amf_file.cpp"
+			,"xcsg/amf_file.h"
+			,"xcsg/boolean_timer.cpp"
+			,"xcsg/boolean_timer.h"
+			,"xcsg/boost_command_line.cpp"
+			,"xcsg/boost_command_line.h"
+			,"xcsg/cancel_token.cpp"
+			,"xcsg/cancel_token.h"
+			,"xcsg/carve_boolean.cpp"
+			,"xcsg/carve_boolean.h"
+			,"xcsg/carve_boolean_thread.cpp"
+			,"xcsg/carve_boolean_thread.h"
+			,"xcsg/carve_mesh_thread.cpp"
+			,"xcsg/carve_mesh_thread.h"
+			,"xcsg/carve_minkowski_hull.cpp"
+			,"xcsg/carve_minkowski_hull.h"
+			,"xcsg/carve_minkowski_thread.cpp"
+			,"xcsg/carve_minkowski_thread.h"
+			,"xcsg/carve_triangulate.cpp"
+			,"xcsg/carve_triangulate.h"
+			,"xcsg/carve_triangulate_face.cpp"
+			,"xcsg/carve_triangulate_face.h"
+			,"xcsg/clipper_boolean.cpp"
+			,"xcsg/clipper_boolean.h"
+			,"xcsg/clipper_csg/clipper.cpp"
+			,"xcsg/clipper_csg/clipper_csg_config.h"
+			,"xcsg/clipper_csg/clipper_offset.cpp"
+			,"xcsg/clipper_csg/clipper_offset.h"
+			,"xcsg/clipper_csg/clipper_profile.cpp"
+			,"xcsg/clipper_csg/clipper_profile.h"
+			,"xcsg/clipper_csg/contour2d.cpp"
+			,"xcsg/clipper_csg/contour2d.h"
+			,"xcsg/clipper_csg/dmesh_adapter.cpp"
+			,"xcsg/clipper_csg/dmesh_adapter.h"
+			,"xcsg/clipper_csg/polygon2d.cpp"
+			,"xcsg/clipper_csg/polygon2d.h"
+			,"xcsg/clipper_csg/polymesh2d.cpp"
+			,"xcsg/clipper_csg/polymesh2d.h"
+			,"xcsg/clipper_csg/polyset2d.cpp"
+			,"xcsg/clipper_csg/polyset2d.h"
+			,"xcsg/clipper_csg/tmesh_adapter.cpp"
+			,"xcsg/clipper_csg/tmesh_adapter.h"
+			,"xcsg/clipper_csg/vmap2d.cpp"
+			,"xcsg/clipper_csg/vmap2d.h"
+			,"xcsg/convex_polygon.cpp"
+			,"xcsg/convex_polygon.h"
+			,"xcsg/dxf_file.cpp"
+			,"xcsg/dxf_file.h"
+			,"xcsg/extrude_mesh.cpp"
+			,"xcsg/extrude_mesh.h"
+			,"xcsg/flat_key_map.h"
+			,"xcsg/geodesic_sphere.cpp"
+			,"xcsg/geodesic_sphere.h"
+			,"xcsg/lump_mesh.cpp"
+			,"xcsg/lump_mesh.h"
+			,"xcsg/mesh_stats.cpp"
+			,"xcsg/mesh_stats.h"
+			,"xcsg/mesh_utils.cpp"
+			,"xcsg/mesh_utils.h"
+			,"xcsg/mesh_validator.cpp"
+			,"xcsg/mesh_validator.h"
+			,"xcsg/openscad_csg.cpp"
+			,"xcsg/openscad_csg.h"
+			,"xcsg/out_triangles.cpp"
+			,"xcsg/out_triangles.h"
+			,"xcsg/perf_counters.cpp"
+			,"xcsg/perf_counters.h"
+			,"xcsg/polymesh3d.cpp"
+			,"xcsg/polymesh3d.h"
+			,"xcsg/primitives2d.cpp"
+			,"xcsg/primitives2d.h"
+			,"xcsg/primitives3d.cpp"
+			,"xcsg/primitives3d.h"
+			,"xcsg/project_mesh.cpp"
+			,"xcsg/project_mesh.h"
+			,"xcsg/run_concurrently.h"
+			,"xcsg/safe_queue.h"
+			,"xcsg/std_filename.cpp"
+			,"xcsg/std_filename.h"
+			,"xcsg/svg_file.cpp"
+			,"xcsg/svg_file.h"
+			,"xcsg/sweep_mesh.cpp"
+			,"xcsg/sweep_mesh.h"
+			,"xcsg/sweep_path.cpp"
+			,"xcsg/sweep_path.h"
+			,"xcsg/sweep_path_linear.cpp"
+			,"xcsg/sweep_path_linear.h"
+			,"xcsg/sweep_path_rotate.cpp"
+			,"xcsg/sweep_path_rotate.h"
+			,"xcsg/sweep_path_spline.cpp"
+			,"xcsg/sweep_path_spline.h"
+			,"xcsg/sweep_path_transform.cpp"
+			,"xcsg/sweep_path_transform.h"
+			,"xcsg/text_buffer.cpp"
+			,"xcsg/text_buffer.h"
+			,"xcsg/tin_mesh.cpp"
+			,"xcsg/tin_mesh.h"
+			,"xcsg/version.h"
+			,"xcsg/xcircle.cpp"
+			,"xcsg/xcircle.h"
+			,"xcsg/xcone.cpp"
+			,"xcsg/xcone.h"
+			,"xcsg/xcsg_factory.cpp"
+			,"xcsg/xcsg_factory.h"
+			,"xcsg/xcsg_main.cpp"
+			,"xcsg/xcsg_main.h"
+			,"xcsg/xcsg_status.cpp"
+			,"xcsg/xcsg_status.h"
+			,"xcsg/xcube.cpp"
+			,"xcsg/xcube.h"
+			,"xcsg/xcuboid.cpp"
+			,"xcsg/xcuboid.h"
+			,"xcsg/xcylinder.cpp"
+			,"xcsg/xcylinder.h"
+			,"xcsg/xdifference2d.cpp"
+			,"xcsg/xdifference2d.h"
+			,"xcsg/xdifference3d.cpp"
+			,"xcsg/xdifference3d.h"
+			,"xcsg/xface.cpp"
+			,"xcsg/xface.h"
+			,"xcsg/xfill2d.cpp"
+			,"xcsg/xfill2d.h"
+			,"xcsg/xhull2d.cpp"
+			,"xcsg/xhull2d.h"
+			,"xcsg/xhull3d.cpp"
+			,"xcsg/xhull3d.h"
+			,"xcsg/xintersection2d.cpp"
+			,"xcsg/xintersection2d.h"
+			,"xcsg/xintersection3d.cpp"
+			,"xcsg/xintersection3d.h"
+			,"xcsg/xlinear_extrude.cpp"
+			,"xcsg/xlinear_extrude.h"
+			,"xcsg/xminkowski2d.cpp"
+			,"xcsg/xminkowski2d.h"
+			,"xcsg/xminkowski3d.cpp"
+			,"xcsg/xminkowski3d.h"
+			,"xcsg/xoffset2d.cpp"
+			,"xcsg/xoffset2d.h"
+			,"xcsg/xpolygon.cpp"
+			,"xcsg/xpolygon.h"
+			,"xcsg/xpolyhedron.cpp"
+			,"xcsg/xpolyhedron.h"
+			,"xcsg/xprojection2d.cpp"
+			,"xcsg/xprojection2d.h"
+			,"xcsg/xrectangle.cpp"
+			,"xcsg/xrectangle.h"
+			,"xcsg/xrotate_extrude.cpp"
+			,"xcsg/xrotate_extrude.h"
+			,"xcsg/xshape.cpp"
+			,"xcsg/xshape.h"
+			,"xcsg/xshape2d.cpp"
+			,"xcsg/xshape2d.h"
+			,"xcsg/xshape2d_collector.cpp"
+			,"xcsg/xshape2d_collector.h"
+			,"xcsg/xsolid.cpp"
+			,"xcsg/xsolid.h"
+			,"xcsg/xsolid_collector.cpp"
+			,"xcsg/xsolid_collector.h"
+			,"xcsg/xsphere.cpp"
+			,"xcsg/xsphere.h"
+			,"xcsg/xspline_path.cpp"
+			,"xcsg/xspline_path.h"
+			,"xcsg/xsquare.cpp"
+			,"xcsg/xsquare.h"
+			,"xcsg/xsweep.cpp"
+			,"xcsg/xsweep.h"
+			,"xcsg/xtin_model.cpp"
+			,"xcsg/xtin_model.h"
+			,"xcsg/xtmatrix.cpp"
+			,"xcsg/xtmatrix.h"
+			,"xcsg/xtransform_extrude.cpp"
+			,"xcsg/xtransform_extrude.h"
+			,"xcsg/xunion2d.cpp"
+			,"xcsg/xunion2d.h"
+			,"xcsg/xunion3d.cpp"
+			,"xcsg/xunion3d.h"
+			,"xcsg/zip_streambuf.cpp"
+			,"xcsg/zip_streambuf.h"
+			,"xcsg_bench/bench_carve.cpp"
+			,"xcsg_bench/bench_clipper.cpp"
+			,"xcsg_bench/bench_export.cpp"
+			,"xcsg_bench/bench_main.cpp"
+			,"xcsg_bench/bench_mesh2d.cpp"
+			,"xcsg_bench/bench_parse.cpp"
+			,"xcsg_bench/bench_primitives3d.cpp"
+			,"xcsg_bench/micro_bench.cpp"
+			,"xcsg_bench/micro_bench.h"
+			}
+
+		filter { "configurations:debug" }
+			defines  ( "DEBUG" ) 
+			kind ( "ConsoleApp" ) 
+			-- When linking within workspace, 'links' refer to project name.
+			links { "carve","csg_parser","csplines","dmesh","qhull","tmesh" } 
+			links { iif(os.istarget("windows"),"zlib","z") } 
+			symbols  ( "on" ) 
+		filter { }
+
+		filter { "configurations:release" }
+			defines  ( "NDEBUG" ) 
+			kind ( "ConsoleApp" ) 
+			-- When linking within workspace, 'links' refer to project name.
+			links { "carve","csg_parser","csplines","dmesh","qhull","tmesh" } 
+			links { iif(os.istarget("windows"),"zlib","z") } 
 			optimize  ( "on" ) 
 		filter { }
@@ -0,0 +1,372 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "cf_xmlBinary.h"
+#include "cf_xmlPayload.h"
+#include "cf_xmlPullParser.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+
+// known tags, stored by index. New tags must be added at the end
+static const char* known_tags[] = {
+   "xcsg", "metadata", "software", "model",
+   "cone", "cube", "cuboid", "cylinder", "difference3d", "intersection3d", "polyhedron", "sphere", "tin_model",
+   "union3d", "hull3d", "linear_extrude", "rotate_extrude", "transform_extrude", "sweep", "minkowski3d",
+   "circle", "polygon", "rectangle", "square", "difference2d", "intersection2d", "union2d", "hull2d",
+   "fill2d", "offset2d", "minkowski2d", "projection2d",
+   "tmatrix", "trow", "vertices", "vertex", "faces", "face", "fv", "spline_path", "cpoint"
+};
+static const uint32_t num_known_tags = sizeof(known_tags)/sizeof(known_tags[0]);
+
+static const char     file_magic[4]  = { 'X','C','S','B' };
+static const uint32_t byte_order     = 0x01020304;
+static const uint32_t file_version   = 1;
+static const uint32_t string_tag     = 0x80000000;
+static const size_t   header_size    = 32;
+
+enum content_kind { CONTENT_NONE=0, CONTENT_TEXT=1, CONTENT_VALUES=2, CONTENT_FACES=3 };
+enum attribute_type { ATTR_DOUBLE=0, ATTR_STRING=1 };
+
+// shortest representation of a double that reads back to the same value
+static std::string format_double(double value)
+{
+   char buf[32];
+   auto res = std::to_chars(buf,buf+sizeof(buf),value);
+   return std::string(buf,res.ptr);
+}
+
+// ==== writer
+
+class binary_writer {
+public:
+   binary_writer(const std::string& path)
+   : m_path(path)
+   , m_file(std::fopen(path.c_str(),"wb"))
+   , m_ok(m_file != nullptr)
+   , m_pos(0)
+   {
+      if(!m_file) throw std::logic_error("cf_xmlBinary: could not open " + path);
+      for(uint32_t i=0; i<num_known_tags; i++) m_tags[known_tags[i]] = i;
+   }
+
+   ~binary_writer()
+   {
+      if(m_file) std::fclose(m_file);
+   }
+
+   void write(const void* data, size_t nbytes)
+   {
+      if(nbytes > 0) m_ok = m_ok && (std::fwrite(data,1,nbytes,m_file) == nbytes);
+      m_pos += nbytes;
+   }
+   template <typename T> void put(T value) { write(&value,sizeof(T)); }
+
+   void pad()
+   {
+      static const char zeros[8] = {0};
+      write(zeros,(8 - m_pos%8)%8);
+   }
+
+   uint32_t string_index(const std::string& s)
+   {
+      auto i = m_strings.find(s);
+      if(i != m_strings.end()) return i->second;
+      uint32_t index = static_cast<uint32_t>(m_string_list.size());
+      m_strings[s] = index;
+      m_string_list.push_back(s);
+      return index;
+   }
+
+   uint32_t tag_index(const std::string& tag)
+   {
+      auto i = m_tags.find(tag);
+      if(i != m_tags.end()) return i->second;
+      return string_index(tag) | string_tag;
+   }
+
+   void write_node(const std::string& tag, const cf_xmlBinary::ptree& node)
+   {
+      std::vector<std::pair<std::string,std::string>> attributes;
+      std::vector<const cf_xmlBinary::ptree::value_type*> children;
+      std::shared_ptr<const cf_xmlPayload> payload;
+      for(auto& child : node) {
+         if(child.first == "<xmlattr>") {
+            for(auto& a : child.second) attributes.push_back(std::make_pair(a.first,a.second.data()));
+         }
+         else if(child.first == "<xmlpayload>") {
+            payload = cf_xmlPayloadRegistry::singleton().get(child.second.get_value<size_t>());
+            if(!payload) throw std::logic_error("cf_xmlBinary: payload not found in <" + tag + ">");
+         }
+         else {
+            children.push_back(&child);
+         }
+      }
+
+      uint32_t kind = CONTENT_NONE;
+      if(payload) kind = (payload->stride() > 0)? CONTENT_VALUES : CONTENT_FACES;
+      else if(node.data().size() > 0) kind = CONTENT_TEXT;
+
+      put<uint32_t>(tag_index(tag));
+      put<uint32_t>(static_cast<uint32_t>(attributes.size()));
+      put<uint32_t>(static_cast<uint32_t>(children.size()));
+      put<uint32_t>(kind);
+
+      for(auto& a : attributes) {
+         put<uint32_t>(string_index(a.first));
+
+         // numbers are stored as double if the text is reproduced exactly when read back
+         double value = 0.0;
+         if(cf_xmlPullParser::to_double(a.second,value) && format_double(value) == a.second) {
+            put<uint32_t>(ATTR_DOUBLE);
+            put<double>(value);
+         }
+         else {
+            put<uint32_t>(ATTR_STRING);
+            put<uint64_t>(string_index(a.second));
+         }
+      }
+
+      if(kind == CONTENT_TEXT) {
+         put<uint32_t>(string_index(node.data()));
+         put<uint32_t>(0);
+      }
+      else if(kind == CONTENT_VALUES) {
+         cf_xmlArray<double> values = payload->values();
+         put<uint64_t>(payload->stride());
+         put<uint64_t>(values.size());
+         write(values.data(),values.size()*sizeof(double));
+      }
+      else if(kind == CONTENT_FACES) {
+         cf_xmlArray<uint32_t> rows = payload->face_row();
+         cf_xmlArray<uint32_t> ind  = payload->face_ind();
+         put<uint64_t>(rows.size()-1);
+         put<uint64_t>(ind.size());
+         write(rows.data(),rows.size()*sizeof(uint32_t));
+         write(ind.data(),ind.size()*sizeof(uint32_t));
+         pad();
+      }
+
+      for(auto child : children) write_node(child->first,child->second);
+   }
+
+   void write_header(uint64_t strings_offset, uint64_t num_strings)
+   {
+      write(file_magic,4);
+      put<uint32_t>(byte_order);
+      put<uint32_t>(file_version);
+      put<uint32_t>(0);
+      put<uint64_t>(strings_offset);
+      put<uint64_t>(num_strings);
+   }
+
+   void write_file(const cf_xmlBinary::ptree& tree)
+   {
+      if(tree.size() != 1) throw std::logic_error("cf_xmlBinary: tree must have exactly one root node");
+
+      // the header is written again when the string table offset is known
+      write_header(0,0);
+      write_node(tree.begin()->first,tree.begin()->second);
+
+      uint64_t strings_offset = m_pos;
+      for(auto& s : m_string_list) {
+         put<uint32_t>(static_cast<uint32_t>(s.size()));
+         write(s.data(),s.size());
+         pad();
+      }
+
+      if(m_ok) m_ok = (std::fseek(m_file,0,SEEK_SET) == 0);
+      write_header(strings_offset,m_string_list.size());
+      m_ok = (std::fclose(m_file) == 0) && m_ok;
+      m_file = nullptr;
+      if(!m_ok) throw std::logic_error("cf_xmlBinary: failed to write " + m_path);
+   }
+
+private:
+   std::string m_path;
+   FILE*       m_file;
+   bool        m_ok;
+   uint64_t    m_pos;
+   std::map<std::string,uint32_t> m_tags;
+   std::map<std::string,uint32_t> m_strings;
+   std::vector<std::string>       m_string_list;
+};
+
+void cf_xmlBinary::write(const ptree& tree, const std::string& path)
+{
+   binary_writer writer(path);
+   writer.write_file(tree);
+}
+
+// ==== reader
+
+// the mapped file, kept alive by the payloads referring to it
+struct mapped_file {
+   mapped_file(const std::string& path)
+   : file(path.c_str(),boost::interprocess::read_only)
+   , region(file,boost::interprocess::read_only)
+   {}
+   boost::interprocess::file_mapping  file;
+   boost::interprocess::mapped_region region;
+};
+
+class binary_reader {
+public:
+   binary_reader(std::shared_ptr<mapped_file> mapped, std::vector<size_t>& payloads)
+   : m_mapped(mapped)
+   , m_begin(static_cast<const char*>(mapped->region.get_address()))
+   , m_end(m_begin + mapped->region.get_size())
+   , m_pos(m_begin)
+   , m_payloads(payloads)
+   {}
+
+   const char* take(size_t nbytes)
+   {
+      if(size_t(m_end-m_pos) < nbytes) throw std::logic_error("cf_xmlBinary: unexpected end of file");
+      const char* p = m_pos;
+      m_pos += nbytes;
+      return p;
+   }
+   template <typename T> T get() { T value; std::memcpy(&value,take(sizeof(T)),sizeof(T)); return value; }
+
+   void pad()
+   {
+      take((8 - (m_pos-m_begin)%8)%8);
+   }
+
+   std::string_view string_at(uint64_t index) const
+   {
+      if(index >= m_strings.size()) throw std::logic_error("cf_xmlBinary: invalid string index");
+      return m_strings[index];
+   }
+
+   void read_header()
+   {
+      if(std::memcmp(take(4),file_magic,4) != 0) throw std::logic_error("cf_xmlBinary: not an .xcsgb file");
+      if(get<uint32_t>() != byte_order)          throw std::logic_error("cf_xmlBinary: unsupported byte order");
+      if(get<uint32_t>() != file_version)        throw std::logic_error("cf_xmlBinary: unsupported file version");
+      get<uint32_t>();
+      uint64_t strings_offset = get<uint64_t>();
+      uint64_t num_strings    = get<uint64_t>();
+      if(strings_offset > uint64_t(m_end-m_begin)) throw std::logic_error("cf_xmlBinary: invalid string table offset");
+
+      const char* nodes = m_pos;
+      m_pos = m_begin + strings_offset;
+      m_strings.reserve(num_strings);
+      for(uint64_t i=0; i<num_strings; i++) {
+         uint32_t len = get<uint32_t>();
+         m_strings.push_back(std::string_view(take(len),len));
+         pad();
+      }
+      m_pos = nodes;
+   }
+
+   void read_node(cf_xmlBinary::ptree& parent)
+   {
+      uint32_t tag_id   = get<uint32_t>();
+      uint32_t nattr    = get<uint32_t>();
+      uint32_t nchild   = get<uint32_t>();
+      uint32_t kind     = get<uint32_t>();
+
+      std::string tag;
+      if(tag_id & string_tag)         tag = std::string(string_at(tag_id & ~string_tag));
+      else if(tag_id < num_known_tags) tag = known_tags[tag_id];
+      else throw std::logic_error("cf_xmlBinary: unknown tag number " + std::to_string(tag_id));
+
+      cf_xmlBinary::ptree& node = parent.push_back(cf_xmlBinary::ptree::value_type(tag,cf_xmlBinary::ptree()))->second;
+
+      if(nattr > 0) {
+         cf_xmlBinary::ptree& attr = node.push_back(cf_xmlBinary::ptree::value_type("<xmlattr>",cf_xmlBinary::ptree()))->second;
+         for(uint32_t i=0; i<nattr; i++) {
+            std::string name(string_at(get<uint32_t>()));
+            uint32_t type = get<uint32_t>();
+            std::string value;
+            if(type == ATTR_DOUBLE)      value = format_double(get<double>());
+            else if(type == ATTR_STRING) value = std::string(string_at(get<uint64_t>()));
+            else throw std::logic_error("cf_xmlBinary: unknown attribute type");
+            attr.push_back(cf_xmlBinary::ptree::value_type(name,cf_xmlBinary::ptree(value)));
+         }
+      }
+
+      if(kind == CONTENT_TEXT) {
+         node.data() = std::string(string_at(get<uint32_t>()));
+         get<uint32_t>();
+      }
+      else if(kind == CONTENT_VALUES) {
+         uint64_t stride = get<uint64_t>();
+         uint64_t count  = get<uint64_t>();
+         if(stride == 0 || count%stride != 0) throw std::logic_error("cf_xmlBinary: invalid value count");
+         if(count > uint64_t(m_end-m_pos)/sizeof(double)) throw std::logic_error("cf_xmlBinary: unexpected end of file");
+         const double* values = reinterpret_cast<const double*>(take(count*sizeof(double)));
+         add_payload(node,cf_xmlPayload::make_external(m_mapped,stride,cf_xmlArray<double>(values,count),
+                                                       cf_xmlArray<uint32_t>(),cf_xmlArray<uint32_t>()));
+      }
+      else if(kind == CONTENT_FACES) {
+         uint64_t nfaces = get<uint64_t>();
+         uint64_t nind   = get<uint64_t>();
+         // each bound is checked separately, so the sum cannot wrap
+         uint64_t avail  = uint64_t(m_end-m_pos)/sizeof(uint32_t);
+         if(nfaces >= avail || nind > avail-nfaces-1) throw std::logic_error("cf_xmlBinary: unexpected end of file");
+         const uint32_t* rows = reinterpret_cast<const uint32_t*>(take((nfaces+1)*sizeof(uint32_t)));
+         const uint32_t* ind  = reinterpret_cast<const uint32_t*>(take(nind*sizeof(uint32_t)));
+         pad();
+         for(uint64_t i=0; i<nfaces; i++) {
+            if(rows[i] > rows[i+1] || rows[i+1] > nind) throw std::logic_error("cf_xmlBinary: invalid face data");
+         }
+         add_payload(node,cf_xmlPayload::make_external(m_mapped,0,cf_xmlArray<double>(),
+                                                       cf_xmlArray<uint32_t>(rows,nfaces+1),cf_xmlArray<uint32_t>(ind,nind)));
+      }
+      else if(kind != CONTENT_NONE) {
+         throw std::logic_error("cf_xmlBinary: unknown content kind");
+      }
+
+      for(uint32_t i=0; i<nchild; i++) read_node(node);
+   }
+
+   void add_payload(cf_xmlBinary::ptree& node, std::shared_ptr<const cf_xmlPayload> payload)
+   {
+      size_t id = cf_xmlPayloadRegistry::singleton().add(payload);
+      m_payloads.push_back(id);
+      node.push_back(cf_xmlBinary::ptree::value_type("<xmlpayload>",cf_xmlBinary::ptree(std::to_string(id))));
+   }
+
+private:
+   std::shared_ptr<mapped_file>  m_mapped;
+   const char*                   m_begin;
+   const char*                   m_end;
+   const char*                   m_pos;
+   std::vector<size_t>&          m_payloads;
+   std::vector<std::string_view> m_strings;
+};
+
+void cf_xmlBinary::read(const std::string& path, ptree& tree, std::vector<size_t>& payloads)
+{
+   std::shared_ptr<mapped_file> mapped;
+   try {
+      mapped = std::make_shared<mapped_file>(path);
+   }
+   catch(std::exception& ex) {
+      throw std::logic_error("cf_xmlBinary: could not map " + path + ": " + ex.what());
+   }
+
+   binary_reader reader(mapped,payloads);
+   reader.read_header();
+   reader.read_node(tree);
+}
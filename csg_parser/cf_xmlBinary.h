@@ -0,0 +1,52 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef CF_XMLBINARY_H
+#define CF_XMLBINARY_H
+
+#include <boost/property_tree/ptree.hpp>
+#include <string>
+#include <vector>
+
+// cf_xmlBinary reads and writes the binary .xcsgb form of an xml tree. Known tags are stored
+// as numbers, numeric attributes as doubles and payloads (see cf_xmlPayload) as raw arrays.
+// All values are little endian and arrays are 8 byte aligned, so a memory mapped file is
+// used directly by the payloads, without copying.
+//
+//   header   "XCSB", uint32 byte order mark 0x01020304, uint32 version, uint32 unused,
+//            uint64 offset of string table, uint64 number of strings
+//   nodes    root node, each node is followed by its children, depth first
+//            uint32 tag: index in known tag list, or string index | 0x80000000
+//            uint32 number of attributes, uint32 number of children, uint32 content kind
+//            attributes:  uint32 name string, uint32 type (0=double, 1=string), 8 byte value
+//            content 1 (text):   uint32 string, uint32 unused
+//            content 2 (values): uint64 stride, uint64 count, count x float64
+//            content 3 (faces):  uint64 nfaces, uint64 nind, nfaces+1 x uint32 rows,
+//                                nind x uint32 indices, padded to 8 bytes
+//   strings  uint32 length and characters, padded to 8 bytes
+
+class cf_xmlBinary {
+public:
+   typedef boost::property_tree::ptree ptree;
+
+   // write tree to file, throws std::logic_error on failure
+   static void write(const ptree& tree, const std::string& path);
+
+   // memory map file and build tree, the registry ids of the payloads created are
+   // appended to payloads. Throws std::logic_error on failure
+   static void read(const std::string& path, ptree& tree, std::vector<size_t>& payloads);
+};
+
+#endif // CF_XMLBINARY_H
@@ -0,0 +1,285 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "cf_xmlJson.h"
+#include "cf_xmlPayload.h"
+#include <charconv>
+#include <cctype>
+#include <stdexcept>
+
+class json_reader {
+public:
+   typedef cf_xmlJson::ptree ptree;
+
+   json_reader(const char* begin, const char* end, std::vector<size_t>& payloads)
+   : m_begin(begin)
+   , m_end(end)
+   , m_pos(begin)
+   , m_payloads(payloads)
+   {}
+
+   [[noreturn]] void error(const std::string& message) const
+   {
+      size_t line = 1;
+      for(const char* p=m_begin; p<m_pos; p++) if(*p == '\n') line++;
+      throw std::logic_error("json parse error at line " + std::to_string(line) + ": " + message);
+   }
+
+   // next non whitespace character, not consumed
+   char peek()
+   {
+      while(m_pos<m_end && (*m_pos==' ' || *m_pos=='\t' || *m_pos=='\r' || *m_pos=='\n')) m_pos++;
+      if(m_pos == m_end) error("unexpected end of input");
+      return *m_pos;
+   }
+
+   void expect(char c)
+   {
+      if(peek() != c) error(std::string("expected '") + c + "'");
+      m_pos++;
+   }
+
+   void read_document(ptree& tree);
+
+private:
+   struct frame {
+      ptree*      node;        // element receiving the members
+      std::string key;         // tag of the elements in an array
+      bool        array;
+      bool        attributes;  // "<xmlattr>" object
+      bool        first;
+   };
+
+   void append_utf8(std::string& text, unsigned long cp);
+   unsigned long read_hex4();
+   std::string read_string();
+   std::string read_scalar();
+   void read_payload(ptree& parent, const std::string& tag);
+
+private:
+   const char*          m_begin;
+   const char*          m_end;
+   const char*          m_pos;
+   std::vector<size_t>& m_payloads;
+};
+
+void json_reader::append_utf8(std::string& text, unsigned long cp)
+{
+   if(cp < 0x80) {
+      text += static_cast<char>(cp);
+   }
+   else if(cp < 0x800) {
+      text += static_cast<char>(0xC0 | (cp >> 6));
+      text += static_cast<char>(0x80 | (cp & 0x3F));
+   }
+   else if(cp < 0x10000) {
+      text += static_cast<char>(0xE0 | (cp >> 12));
+      text += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      text += static_cast<char>(0x80 | (cp & 0x3F));
+   }
+   else {
+      text += static_cast<char>(0xF0 | (cp >> 18));
+      text += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+      text += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      text += static_cast<char>(0x80 | (cp & 0x3F));
+   }
+}
+
+unsigned long json_reader::read_hex4()
+{
+   if(m_end-m_pos < 4) error("unexpected end of input in \\u escape");
+   unsigned long cp = 0;
+   auto res = std::from_chars(m_pos,m_pos+4,cp,16);
+   if(res.ptr != m_pos+4) error("invalid \\u escape");
+   m_pos += 4;
+   return cp;
+}
+
+std::string json_reader::read_string()
+{
+   expect('"');
+   std::string text;
+   while(true) {
+      // copy the run up to the next quote or escape
+      const char* run = m_pos;
+      while(m_pos<m_end && *m_pos!='"' && *m_pos!='\\') m_pos++;
+      text.append(run,m_pos);
+      if(m_pos == m_end) error("unterminated string");
+      if(*m_pos++ == '"') return text;
+
+      if(m_pos == m_end) error("unterminated string");
+      char c = *m_pos++;
+      switch(c) {
+         case '"': case '\\': case '/': text += c; break;
+         case 'b': text += '\b'; break;
+         case 'f': text += '\f'; break;
+         case 'n': text += '\n'; break;
+         case 'r': text += '\r'; break;
+         case 't': text += '\t'; break;
+         case 'u':
+         {
+            unsigned long cp = read_hex4();
+            if(cp >= 0xD800 && cp < 0xDC00 && m_end-m_pos >= 2 && m_pos[0]=='\\' && m_pos[1]=='u') {
+               // surrogate pair
+               m_pos += 2;
+               unsigned long low = read_hex4();
+               if(low < 0xDC00 || low >= 0xE000) error("invalid surrogate pair");
+               cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            }
+            append_utf8(text,cp);
+            break;
+         }
+         default: error(std::string("invalid escape '\\") + c + "'");
+      };
+   }
+}
+
+// string, number or literal as text
+std::string json_reader::read_scalar()
+{
+   if(peek() == '"') return read_string();
+
+   const char* token = m_pos;
+   while(m_pos<m_end && (std::isalnum(static_cast<unsigned char>(*m_pos)) || *m_pos=='-' || *m_pos=='+' || *m_pos=='.')) m_pos++;
+   std::string text(token,m_pos);
+   if(text == "true" || text == "false") return text;
+   if(text == "null") return std::string();
+
+   double value = 0.0;
+   auto res = std::from_chars(token,m_pos,value);
+   if(text.size() == 0 || res.ec != std::errc() || res.ptr != m_pos) error("invalid value '" + text + "'");
+   return text;
+}
+
+// array of numeric rows, read directly into a payload
+void json_reader::read_payload(ptree& parent, const std::string& tag)
+{
+   bool faces = (tag == "faces");
+   std::vector<double> values;
+   size_t count    = 0;
+   size_t row_size = 0;
+
+   expect('[');
+   if(peek() == ']') m_pos++;
+   else while(true) {
+      expect('[');
+      size_t irow = values.size();
+      if(faces) values.push_back(0.0);  // number of face vertices, set below
+
+      size_t n = 0;
+      if(peek() == ']') m_pos++;
+      else while(true) {
+         double value = 0.0;
+         peek();
+         auto res = std::from_chars(m_pos,m_end,value);
+         if(res.ec != std::errc()) error("expected number in <" + tag + ">");
+         m_pos = res.ptr;
+         values.push_back(value);
+         n++;
+
+         char c = peek();
+         m_pos++;
+         if(c == ']') break;
+         if(c != ',') error("expected ',' or ']' in <" + tag + ">");
+      }
+
+      if(faces) values[irow] = double(n);
+      else if(count > 0 && n != row_size) error("rows of <" + tag + "> must have the same number of values");
+      row_size = n;
+      count++;
+
+      char c = peek();
+      m_pos++;
+      if(c == ']') break;
+      if(c != ',') error("expected ',' or ']' in <" + tag + ">");
+   }
+
+   auto payload = std::make_shared<cf_xmlPayload>();
+   try {
+      payload->assign(tag,count,values);
+   }
+   catch(std::logic_error& ex) {
+      error(ex.what());
+   }
+   size_t id = cf_xmlPayloadRegistry::singleton().add(payload);
+   m_payloads.push_back(id);
+   ptree& node = parent.push_back(ptree::value_type(tag,ptree()))->second;
+   node.push_back(ptree::value_type("<xmlpayload>",ptree(std::to_string(id))));
+}
+
+void json_reader::read_document(ptree& tree)
+{
+   // objects and arrays not yet closed
+   std::vector<frame> open;
+
+   expect('{');
+   open.push_back(frame{&tree,"",false,false,true});
+   while(open.size() > 0) {
+      frame& f = open.back();
+      ptree* node = f.node;
+      if(peek() == (f.array? ']' : '}')) {
+         m_pos++;
+         open.pop_back();
+         continue;
+      }
+      if(!f.first) expect(',');
+      f.first = false;
+
+      std::string key = f.key;
+      if(!f.array) {
+         if(peek() != '"') error("expected member name");
+         key = read_string();
+         expect(':');
+      }
+
+      char c = peek();
+      if(f.attributes) {
+         if(c=='{' || c=='[') error("attribute '" + key + "' must be a string, number or boolean");
+         node->push_back(ptree::value_type(key,ptree(read_scalar())));
+      }
+      else if(c == '{') {
+         m_pos++;
+         bool attributes = (!f.array && key == "<xmlattr>");
+         ptree& child = node->push_back(ptree::value_type(key,ptree()))->second;
+         open.push_back(frame{&child,"",false,attributes,true});
+      }
+      else if(c == '[') {
+         if(f.array) error("nested arrays are only allowed in vertices, faces and tmatrix");
+
+         // look past the bracket to tell numeric rows from an array of elements
+         const char* p = m_pos+1;
+         while(p<m_end && (*p==' ' || *p=='\t' || *p=='\r' || *p=='\n')) p++;
+         if(cf_xmlPayload::is_payload(key) && p<m_end && (*p=='[' || *p==']')) {
+            read_payload(*node,key);
+         }
+         else {
+            m_pos++;
+            open.push_back(frame{node,key,true,false,true});
+         }
+      }
+      else {
+         node->push_back(ptree::value_type(key,ptree(read_scalar())));
+      }
+   }
+
+   while(m_pos<m_end && (*m_pos==' ' || *m_pos=='\t' || *m_pos=='\r' || *m_pos=='\n')) m_pos++;
+   if(m_pos<m_end) error("unexpected content after the document");
+}
+
+void cf_xmlJson::read(const char* begin, const char* end, ptree& tree, std::vector<size_t>& payloads)
+{
+   json_reader reader(begin,end,payloads);
+   reader.read_document(tree);
+}
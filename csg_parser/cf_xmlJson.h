@@ -0,0 +1,46 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef CF_XMLJSON_H
+#define CF_XMLJSON_H
+
+#include <boost/property_tree/ptree.hpp>
+#include <string>
+#include <vector>
+
+// cf_xmlJson reads the JSON form of an xcsg tree (.xcsg.json) in a single pass, building the
+// same tree as cf_xmlTree::read_xcsg without going through boost::property_tree::read_json.
+//
+//   {"xcsg": {"<xmlattr>": {"version": "1.0"},
+//             "union3d": {"sphere": [{"<xmlattr>": {"r": 10}},
+//                                    {"<xmlattr>": {"r": 5}, "tmatrix": [[1,0,0,20],[0,1,0,0],[0,0,1,0],[0,0,0,1]]}]}}}
+//
+// Object members are child elements, "<xmlattr>" holds the attributes (strings, numbers or
+// booleans). An array of objects gives one child element per object, the same tag repeated
+// as member name is also accepted, as written by cf_xmlTree::write_json. A string or number
+// member is an element with text content. <vertices>, <faces> and <tmatrix> may be arrays of
+// numeric rows ([x,y,z] or [x,y] per vertex, vertex indices per face, 4 values per matrix row),
+// these are read directly into payloads, see cf_xmlPayload.
+
+class cf_xmlJson {
+public:
+   typedef boost::property_tree::ptree ptree;
+
+   // parse JSON text and build tree, the registry ids of the payloads created are
+   // appended to payloads. Throws std::logic_error on failure
+   static void read(const char* begin, const char* end, ptree& tree, std::vector<size_t>& payloads);
+};
+
+#endif // CF_XMLJSON_H
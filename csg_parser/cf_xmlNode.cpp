@@ -14,31 +14,72 @@
 // EndLicense:
 
 #include "cf_xmlNode.h"
+#include "cf_xmlPayload.h"
 
 #include <boost/algorithm/string.hpp>
+#include <cctype>
+#include <charconv>
 using namespace std;
 using namespace boost::algorithm;
 
 cf_xmlNode::cf_xmlNode()
+: m_attributes(nullptr)
+, m_attributes_found(false)
 {}
 
 cf_xmlNode::cf_xmlNode(const string& tag, ptree& ptree_node)
 : m_tag(tag)
 , m_ptree_node(ptree_node)
+, m_attributes(nullptr)
+, m_attributes_found(false)
 {}
 
 cf_xmlNode::cf_xmlNode(iterator it)
 : m_tag(it->first)
 , m_ptree_node(it->second)
+, m_attributes(nullptr)
+, m_attributes_found(false)
 {}
 
 cf_xmlNode& cf_xmlNode::operator=(const cf_xmlNode& other_node )
 {
-   m_tag        = other_node.m_tag;
-   m_ptree_node = other_node.m_ptree_node;
+   m_tag              = other_node.m_tag;
+   m_ptree_node       = other_node.m_ptree_node;
+   m_attributes       = other_node.m_attributes;
+   m_attributes_found = other_node.m_attributes_found;
    return *this;
 }
 
+const string* cf_xmlNode::attribute(const string& name) const
+{
+   if(!m_ptree_node) return nullptr;
+
+   if(!m_attributes_found) {
+      const ptree& node = m_ptree_node.get();
+      auto i = node.find("<xmlattr>");
+      m_attributes       = (i != node.not_found())? &i->second : nullptr;
+      m_attributes_found = true;
+   }
+   if(!m_attributes) return nullptr;
+
+   auto i = m_attributes->find(name);
+   if(i == m_attributes->not_found()) return nullptr;
+   return &i->second.data();
+}
+
+// convert the complete text, surrounding whitespace allowed, as the ptree stream conversion
+template <typename T>
+static bool convert(const string& text, T& value)
+{
+   const char* p   = text.data();
+   const char* end = p + text.size();
+   while(p<end && std::isspace(static_cast<unsigned char>(*p))) p++;
+   while(end>p && std::isspace(static_cast<unsigned char>(*(end-1)))) end--;
+   if(p<end && *p=='+') p++;
+   auto res = std::from_chars(p,end,value);
+   return (res.ec == std::errc() && res.ptr == end);
+}
+
 cf_xmlNode::~cf_xmlNode()
 {}
 
@@ -62,6 +103,7 @@ bool cf_xmlNode::add_property(const string& name, const string& value)
    if(m_ptree_node) {
       string attrib = "<xmlattr>." + name;
       m_ptree_node.get().put(attrib,value);
+      m_attributes_found = false;  // <xmlattr> may have been created
       return true;
    }
    return false;
@@ -72,6 +114,7 @@ bool cf_xmlNode::add_property(const string& name, size_t value)
    if(m_ptree_node) {
       string attrib = "<xmlattr>." + name;
       m_ptree_node.get().put(attrib,value);
+      m_attributes_found = false;  // <xmlattr> may have been created
       return true;
    }
    return false;
@@ -82,6 +125,7 @@ bool cf_xmlNode::add_property(const string& name, int value)
    if(m_ptree_node) {
       string attrib = "<xmlattr>." + name;
       m_ptree_node.get().put(attrib,value);
+      m_attributes_found = false;  // <xmlattr> may have been created
       return true;
    }
    return false;
@@ -92,6 +136,7 @@ bool cf_xmlNode::add_property(const string& name, double value)
    if(m_ptree_node) {
       string attrib = "<xmlattr>." + name;
       m_ptree_node.get().put(attrib,value);
+      m_attributes_found = false;  // <xmlattr> may have been created
       return true;
    }
    return false;
@@ -99,33 +144,22 @@ bool cf_xmlNode::add_property(const string& name, double value)
 
 bool cf_xmlNode::has_property(const string& name) const
 {
-   if(m_ptree_node) {
-      string attrib = "<xmlattr>." + name;
-      boost::optional<string> v = m_ptree_node.get().get_optional<string>(attrib); // anything can be represented as a string
-      return (bool)v;
-   }
-   return false;
+   return (attribute(name) != nullptr);
 }
 
 string cf_xmlNode::get_property(const string& name, const string& default_value) const
 {
-   if(m_ptree_node) {
-      string attrib = "<xmlattr>." + name;
-      boost::optional<string> v = m_ptree_node.get().get_optional<string>(attrib);
-      if(v) {
-         trim(v.get());
-         return v.get();
-      }
+   if(const string* v = attribute(name)) {
+      return trim_copy(*v);
    }
    return  default_value;
 }
 
 size_t cf_xmlNode::get_property(const string& name, size_t default_value) const
 {
-   if(m_ptree_node) {
-      string attrib = "<xmlattr>." + name;
-      boost::optional<size_t> v = m_ptree_node.get().get_optional<size_t>(attrib);
-      if(v) return v.get();
+   size_t value = 0;
+   if(const string* v = attribute(name)) {
+      if(convert(*v,value)) return value;
    }
    return  default_value;
 }
@@ -133,21 +167,18 @@ size_t cf_xmlNode::get_property(const string& name, size_t default_value) const
 
 int    cf_xmlNode::get_property(const string& name, int default_value) const
 {
-   if(m_ptree_node) {
-      string attrib = "<xmlattr>." + name;
-      boost::optional<int> v = m_ptree_node.get().get_optional<int>(attrib);
-      if(v) return v.get();
+   int value = 0;
+   if(const string* v = attribute(name)) {
+      if(convert(*v,value)) return value;
    }
    return  default_value;
 }
 
 double cf_xmlNode::get_property(const string& name, double default_value) const
 {
-   if(m_ptree_node) {
-      string attrib = "<xmlattr>." + name;
-      boost::optional<double> v = m_ptree_node.get().get_optional<double>(attrib);
-      if(v) return v.get();
-      return  default_value;
+   double value = 0.0;
+   if(const string* v = attribute(name)) {
+      if(convert(*v,value)) return value;
    }
    return  default_value;
 }
@@ -237,9 +268,28 @@ bool cf_xmlNode::has_value() const
    return false;
 }
 
+std::shared_ptr<const cf_xmlPayload> cf_xmlNode::payload() const
+{
+   if(m_ptree_node) {
+      const ptree& node = m_ptree_node.get();
+      auto i = node.find("<xmlpayload>");
+      size_t id = 0;
+      if(i != node.not_found() && convert(i->second.data(),id)) return cf_xmlPayloadRegistry::singleton().get(id);
+
+      // compact encoded content in a tree not read by read_xcsg, decoded on every call
+      if(cf_xmlPayload::is_payload(m_tag) && has_property("encoding")) {
+         auto payload = std::make_shared<cf_xmlPayload>();
+         payload->read_encoded(m_tag,get_property("encoding",string()),get_property("count",size_t(0)),get_value(string()));
+         return payload;
+      }
+   }
+   return nullptr;
+}
+
 cf_xmlNode cf_xmlNode::add_child(const string& tag)
 {
    if(m_ptree_node) {
+      m_attributes_found = false;  // the tag may be <xmlattr>
       return cf_xmlNode(tag, m_ptree_node.get().add_child(tag,ptree()));
    }
    return cf_xmlNode();
@@ -248,9 +298,10 @@ cf_xmlNode cf_xmlNode::add_child(const string& tag)
 bool cf_xmlNode::get_child(const string& tag, cf_xmlNode& child) const
 {
    if(m_ptree_node) {
-      boost::optional<ptree &> child_node = m_ptree_node.get().get_child_optional(tag);
-      if(child_node) {
-         child = cf_xmlNode(tag, child_node.get());
+      ptree& node = m_ptree_node.get();
+      auto i = node.find(tag);
+      if(i != node.not_found()) {
+         child = cf_xmlNode(tag, i->second);
          return true;
       }
    }
@@ -286,5 +337,6 @@ cf_xmlNode::const_iterator cf_xmlNode::end() const
 // returns a valid iterator pointing to the element after the erased.
 cf_xmlNode::iterator cf_xmlNode::erase(iterator it_child)
 {
+   m_attributes_found = false;  // the erased child may be <xmlattr>
    return m_ptree_node.get().erase(it_child);
 }
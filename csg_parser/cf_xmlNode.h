@@ -17,9 +17,11 @@
 #define CF_XMLNODE_H
 
 #include <boost/property_tree/ptree.hpp>
+#include <memory>
 #include <ostream>
 #include <string>
 using namespace std;
+class cf_xmlPayload;
 
 class cf_xmlNode {
    friend class cf_xmlTree;
@@ -76,6 +78,10 @@ public:
    // check if a value exists on this node
    bool has_value() const;
 
+   // return the payload of a <vertices>, <faces> or <tmatrix> node read by cf_xmlTree::read_xcsg,
+   // or of a compact encoded node. Return nullptr if the node has its content as child nodes
+   std::shared_ptr<const cf_xmlPayload> payload() const;
+
    // ====== child nodes
 
    // add a child node to this node, return a child reference
@@ -104,9 +110,17 @@ public:
 private:
    cf_xmlNode(const string& tag, ptree& m_ptree_node);
 
+   // return the text of the named attribute, nullptr if not found
+   const string* attribute(const string& name) const;
+
 private:
    string  m_tag;
    boost::optional<ptree &> m_ptree_node;
+
+   // the "<xmlattr>" child of the node, looked up on first property access and again after
+   // add_property, add_child or erase. Property access is therefore not thread safe for a single cf_xmlNode object
+   mutable const ptree* m_attributes;
+   mutable bool         m_attributes_found;
 };
 
 #endif // CF_XMLNODE_H
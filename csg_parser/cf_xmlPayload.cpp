@@ -0,0 +1,388 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "cf_xmlPayload.h"
+#include "cf_xmlPullParser.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+bool cf_xmlPayload::is_payload(std::string_view tag)
+{
+   return (tag == "vertices") || (tag == "faces") || (tag == "tmatrix");
+}
+
+// advance to the end of a record element, which may only contain whitespace
+static void end_of_record(cf_xmlPullParser& parser)
+{
+   std::string tag(parser.tag());
+   cf_xmlPullParser::event_type event = parser.next();
+   while(event == cf_xmlPullParser::TEXT && parser.text().find_first_not_of(" \t\r\n") == std::string_view::npos) {
+      event = parser.next();
+   }
+   if(event != cf_xmlPullParser::END_ELEMENT) {
+      parser.error("unexpected content in <" + tag + ">");
+   }
+}
+
+cf_xmlPayload::cf_xmlPayload()
+: m_stride(0)
+, m_face_row(1,0)
+{}
+
+cf_xmlPayload::~cf_xmlPayload()
+{}
+
+void cf_xmlPayload::read(cf_xmlPullParser& parser)
+{
+   std::string_view tag = parser.tag();
+   std::string_view encoding;
+   if(parser.attribute_value("encoding",encoding)) read_encoded(parser,encoding);
+   else if(tag == "vertices")      read_records(parser,"vertex",{"x","y","z"});
+   else if(tag == "tmatrix")  read_records(parser,"trow",{"c0","c1","c2","c3"});
+   else if(tag == "faces")    read_faces(parser);
+   else parser.error("<" + std::string(tag) + "> cannot be read as payload");
+
+   finish();
+}
+
+void cf_xmlPayload::read_records(cf_xmlPullParser& parser, std::string_view record_tag, const std::vector<std::string_view>& names)
+{
+   std::string container(parser.tag());
+   m_stride = names.size();
+   while(true) {
+      cf_xmlPullParser::event_type event = parser.next();
+      if(event == cf_xmlPullParser::END_ELEMENT) return;
+      if(event == cf_xmlPullParser::START_ELEMENT) {
+         if(parser.tag() != record_tag) {
+            parser.error("expected <" + std::string(record_tag) + "> in <" + container + ">, but found <" + std::string(parser.tag()) + ">");
+         }
+
+         // missing attributes are zero
+         for(auto& name : names) {
+            double value = 0.0;
+            std::string_view raw;
+            if(parser.attribute_value(name,raw) && !cf_xmlPullParser::to_double(raw,value)) {
+               parser.error("invalid number in <" + std::string(record_tag) + "> attribute " + std::string(name) + "=\"" + std::string(raw) + "\"");
+            }
+            m_values.push_back(value);
+         }
+
+         end_of_record(parser);
+      }
+   }
+}
+
+void cf_xmlPayload::read_faces(cf_xmlPullParser& parser)
+{
+   while(true) {
+      cf_xmlPullParser::event_type event = parser.next();
+      if(event == cf_xmlPullParser::END_ELEMENT) return;
+      if(event == cf_xmlPullParser::START_ELEMENT) {
+         if(parser.tag() != "face") {
+            parser.error("expected <face> in <faces>, but found <" + std::string(parser.tag()) + ">");
+         }
+
+         while(true) {
+            event = parser.next();
+            if(event == cf_xmlPullParser::END_ELEMENT) break;
+            if(event == cf_xmlPullParser::START_ELEMENT) {
+               if(parser.tag() != "fv") {
+                  parser.error("expected <fv> in <face>, but found <" + std::string(parser.tag()) + ">");
+               }
+               long long index = -1;
+               std::string_view raw;
+               if(!parser.attribute_value("index",raw) || !cf_xmlPullParser::to_long(raw,index)
+                  || index < 0 || index > std::numeric_limits<uint32_t>::max()) {
+                  parser.error("<fv> requires a valid 'index' attribute");
+               }
+               m_face_ind.push_back(static_cast<uint32_t>(index));
+
+               end_of_record(parser);
+            }
+         }
+         if(m_face_ind.size() > std::numeric_limits<uint32_t>::max()) parser.error("too many face vertices");
+         m_face_row.push_back(static_cast<uint32_t>(m_face_ind.size()));
+      }
+   }
+}
+
+void cf_xmlPayload::read_encoded(cf_xmlPullParser& parser, std::string_view encoding)
+{
+   std::string tag(parser.tag());
+   std::string_view raw;
+   long long count = -1;
+   if(!parser.attribute_value("count",raw) || !cf_xmlPullParser::to_long(raw,count) || count < 0) {
+      parser.error("<" + tag + " encoding=\"" + std::string(encoding) + "\"> requires a valid 'count' attribute");
+   }
+
+   // the content is normally a single text event, but may be split by comments
+   std::string_view content;
+   std::string joined;
+   size_t ntext = 0;
+   while(true) {
+      cf_xmlPullParser::event_type event = parser.next();
+      if(event == cf_xmlPullParser::END_ELEMENT) break;
+      if(event == cf_xmlPullParser::START_ELEMENT) parser.error("unexpected element <" + std::string(parser.tag()) + "> in encoded <" + tag + ">");
+      if(event == cf_xmlPullParser::TEXT) {
+         if(ntext++ == 0) content = parser.text();
+         else {
+            if(ntext == 2) joined = std::string(content);
+            joined += ' ';
+            joined += parser.text();
+            content = joined;
+         }
+      }
+   }
+
+   try {
+      read_encoded(tag,encoding,static_cast<size_t>(count),content);
+   }
+   catch(std::logic_error& ex) {
+      parser.error(ex.what());
+   }
+}
+
+// parse whitespace separated numbers
+template <typename T>
+static void parse_text(std::string_view tag, std::string_view content, std::vector<T>& values)
+{
+   const char* p   = content.data();
+   const char* end = p + content.size();
+   while(true) {
+      while(p<end && (*p==' ' || *p=='\t' || *p=='\n' || *p=='\r')) p++;
+      if(p == end) break;
+      if(*p == '+') p++;
+      T value = 0;
+      auto res = std::from_chars(p,end,value);
+      if(res.ec != std::errc() || (res.ptr<end && !(*res.ptr==' ' || *res.ptr=='\t' || *res.ptr=='\n' || *res.ptr=='\r'))) {
+         const char* token_end = p;
+         while(token_end<end && !(*token_end==' ' || *token_end=='\t' || *token_end=='\n' || *token_end=='\r')) token_end++;
+         throw std::logic_error("invalid number '" + std::string(p,token_end-p) + "' in <" + std::string(tag) + ">");
+      }
+      values.push_back(value);
+      p = res.ptr;
+   }
+}
+
+// decode base64 content into little endian values of type T, whitespace is ignored
+template <typename T>
+static void parse_base64(std::string_view tag, std::string_view content, std::vector<T>& values)
+{
+   // character values, -1 for whitespace, -2 for invalid characters
+   static signed char table[256];
+   static bool initialised = [](){
+      std::memset(table,-2,sizeof(table));
+      const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      for(int i=0; i<64; i++) table[static_cast<unsigned char>(chars[i])] = static_cast<signed char>(i);
+      table[' '] = table['\t'] = table['\n'] = table['\r'] = -1;
+      return true;
+   }();
+   (void)initialised;
+
+   std::vector<unsigned char> bytes(content.size()/4*3+3);
+   unsigned char* out = bytes.data();
+   unsigned int quad = 0;
+   int n = 0;
+   size_t i = 0;
+   for(; i<content.size(); i++) {
+      signed char v = table[static_cast<unsigned char>(content[i])];
+      if(v >= 0) {
+         quad = (quad << 6) | static_cast<unsigned int>(v);
+         if(++n == 4) {
+            out[0] = static_cast<unsigned char>(quad >> 16);
+            out[1] = static_cast<unsigned char>(quad >> 8);
+            out[2] = static_cast<unsigned char>(quad);
+            out += 3;
+            quad = 0;
+            n    = 0;
+         }
+      }
+      else if(v == -2) break;
+   }
+
+   // only padding and whitespace may follow, a partial group gives 1 or 2 bytes
+   for(; i<content.size(); i++) {
+      char c = content[i];
+      if(c != '=' && table[static_cast<unsigned char>(c)] != -1) throw std::logic_error("invalid base64 content in <" + std::string(tag) + ">");
+   }
+   if(n == 1) throw std::logic_error("invalid base64 content in <" + std::string(tag) + ">");
+   if(n == 2) { *out++ = static_cast<unsigned char>(quad >> 4); }
+   if(n == 3) { *out++ = static_cast<unsigned char>(quad >> 10); *out++ = static_cast<unsigned char>(quad >> 2); }
+
+   size_t nbytes = out - bytes.data();
+   if(nbytes%sizeof(T) != 0) throw std::logic_error("base64 content of <" + std::string(tag) + "> is not a whole number of values");
+   values.resize(nbytes/sizeof(T));
+   if(nbytes > 0) std::memcpy(values.data(),bytes.data(),nbytes);
+}
+
+void cf_xmlPayload::read_encoded(std::string_view tag, std::string_view encoding, size_t count, std::string_view content)
+{
+   bool base64 = (encoding == "base64");
+   if(!base64 && encoding != "text") throw std::logic_error("unknown encoding '" + std::string(encoding) + "' in <" + std::string(tag) + ">");
+
+   if(tag == "vertices") {
+      std::vector<double> values;
+      if(base64) parse_base64(tag,content,values);
+      else {
+         values.reserve(3*count);
+         parse_text(tag,content,values);
+      }
+      set_vertices(count,values);
+   }
+   else if(tag == "faces") {
+      std::vector<uint32_t> values;
+      if(base64) parse_base64(tag,content,values);
+      else {
+         values.reserve(4*count);
+         parse_text(tag,content,values);
+      }
+      set_faces(count,values);
+   }
+   else {
+      throw std::logic_error("<" + std::string(tag) + "> does not support encoding");
+   }
+
+   finish();
+}
+
+void cf_xmlPayload::assign(std::string_view tag, size_t count, std::vector<double>& values)
+{
+   if(tag == "vertices") {
+      set_vertices(count,values);
+   }
+   else if(tag == "faces") {
+      std::vector<uint32_t> indices(values.size());
+      for(size_t i=0; i<values.size(); i++) {
+         double v = values[i];
+         if(!(v >= 0.0 && v <= double(std::numeric_limits<uint32_t>::max()) && v == std::floor(v))) {
+            throw std::logic_error("<faces> contains invalid value " + std::to_string(v));
+         }
+         indices[i] = static_cast<uint32_t>(v);
+      }
+      set_faces(count,indices);
+   }
+   else if(tag == "tmatrix") {
+      if(values.size() != 4*count) throw std::logic_error("<tmatrix> rows must have 4 values");
+      m_stride = 4;
+      m_values.swap(values);
+   }
+   else {
+      throw std::logic_error("<" + std::string(tag) + "> cannot be assigned as payload");
+   }
+
+   finish();
+}
+
+void cf_xmlPayload::set_vertices(size_t count, std::vector<double>& values)
+{
+   m_stride = 3;
+   if(values.size() == 3*count) {
+      m_values.swap(values);
+   }
+   else if(values.size() == 2*count) {
+      // 2d vertices, z=0
+      m_values.resize(3*count);
+      for(size_t iv=0; iv<count; iv++) {
+         m_values[3*iv]   = values[2*iv];
+         m_values[3*iv+1] = values[2*iv+1];
+         m_values[3*iv+2] = 0.0;
+      }
+   }
+   else {
+      throw std::logic_error("<vertices count=\"" + std::to_string(count) + "\"> contains " + std::to_string(values.size()) + " values, expected 2 or 3 per vertex");
+   }
+}
+
+void cf_xmlPayload::set_faces(size_t count, const std::vector<uint32_t>& values)
+{
+   m_face_row.reserve(count+1);
+   m_face_ind.reserve(values.size());
+   size_t i = 0;
+   while(i < values.size()) {
+      size_t nv = values[i++];
+      if(nv > values.size()-i) throw std::logic_error("<faces> content ends inside a face");
+      m_face_ind.insert(m_face_ind.end(),values.begin()+i,values.begin()+i+nv);
+      if(m_face_ind.size() > std::numeric_limits<uint32_t>::max()) throw std::logic_error("<faces> contains too many face vertices");
+      m_face_row.push_back(static_cast<uint32_t>(m_face_ind.size()));
+      i += nv;
+   }
+   size_t nfaces = m_face_row.size()-1;
+   if(nfaces != count) {
+      throw std::logic_error("<faces count=\"" + std::to_string(count) + "\"> contains " + std::to_string(nfaces) + " faces");
+   }
+}
+
+void cf_xmlPayload::finish()
+{
+   m_values.shrink_to_fit();
+   m_face_row.shrink_to_fit();
+   m_face_ind.shrink_to_fit();
+   m_v_values   = cf_xmlArray<double>(m_values.data(),m_values.size());
+   m_v_face_row = cf_xmlArray<uint32_t>(m_face_row.data(),m_face_row.size());
+   m_v_face_ind = cf_xmlArray<uint32_t>(m_face_ind.data(),m_face_ind.size());
+}
+
+std::shared_ptr<cf_xmlPayload> cf_xmlPayload::make_external(std::shared_ptr<const void> owner, size_t stride,
+                                                            cf_xmlArray<double> values,
+                                                            cf_xmlArray<uint32_t> face_row,
+                                                            cf_xmlArray<uint32_t> face_ind)
+{
+   auto payload = std::make_shared<cf_xmlPayload>();
+   payload->m_face_row.clear();
+   payload->m_owner      = owner;
+   payload->m_stride     = stride;
+   payload->m_v_values   = values;
+   payload->m_v_face_row = face_row;
+   payload->m_v_face_ind = face_ind;
+   return payload;
+}
+
+void cf_xmlPayload::f_get(size_t f_ind, std::vector<size_t>& indices) const
+{
+   indices.assign(m_v_face_ind.begin()+m_v_face_row[f_ind],m_v_face_ind.begin()+m_v_face_row[f_ind+1]);
+}
+
+cf_xmlPayloadRegistry::cf_xmlPayloadRegistry()
+: m_next_id(0)
+{}
+
+cf_xmlPayloadRegistry::~cf_xmlPayloadRegistry()
+{}
+
+size_t cf_xmlPayloadRegistry::add(std::shared_ptr<const cf_xmlPayload> payload)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   size_t id = m_next_id++;
+   m_payloads[id] = payload;
+   return id;
+}
+
+std::shared_ptr<const cf_xmlPayload> cf_xmlPayloadRegistry::get(size_t id) const
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   auto i = m_payloads.find(id);
+   if(i != m_payloads.end()) return i->second;
+   return nullptr;
+}
+
+void cf_xmlPayloadRegistry::remove(size_t id)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   m_payloads.erase(id);
+}
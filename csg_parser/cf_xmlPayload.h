@@ -0,0 +1,154 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef CF_XMLPAYLOAD_H
+#define CF_XMLPAYLOAD_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+class cf_xmlPullParser;
+
+// read only view of a contiguous array
+template <typename T>
+class cf_xmlArray {
+public:
+   cf_xmlArray() : m_data(nullptr), m_size(0) {}
+   cf_xmlArray(const T* data, size_t size) : m_data(data), m_size(size) {}
+
+   size_t   size() const                    { return m_size; }
+   const T* data() const                    { return m_data; }
+   const T& operator[](size_t i) const      { return m_data[i]; }
+   const T* begin() const                   { return m_data; }
+   const T* end() const                     { return m_data+m_size; }
+
+private:
+   const T* m_data;
+   size_t   m_size;
+};
+
+// cf_xmlPayload is the bulk numeric content of a <vertices>, <faces> or <tmatrix> element,
+// parsed directly into arrays by cf_xmlTree::read_xcsg instead of stored as child nodes.
+// The node of such an element refers to its payload, see cf_xmlNode::payload()
+//
+//   <vertices>  values() holds x,y,z per <vertex>, stride 3
+//   <tmatrix>   values() holds c0,c1,c2,c3 per <trow>, stride 4
+//   <faces>     f_size() faces with the <fv> indices of each <face>
+//
+// <vertices> and <faces> may alternatively use a compact encoding of their content,
+// given by the 'encoding' and 'count' attributes:
+//
+//   <vertices count="N" encoding="text">   x y z x y z ...   (x y per vertex in 2d)
+//   <faces count="M" encoding="text">      n i1 .. in  n i1 .. in ...
+//   <vertices count="N" encoding="base64"> little endian float64 values as above
+//   <faces count="M" encoding="base64">    little endian uint32 values as above
+//
+// A payload either owns its arrays, or refers to memory kept alive by an owner object,
+// such as a memory mapped .xcsgb file (see cf_xmlBinary).
+
+class cf_xmlPayload {
+public:
+   // true if elements with this tag are read as payload
+   static bool is_payload(std::string_view tag);
+
+   cf_xmlPayload();
+   virtual ~cf_xmlPayload();
+
+   // create a payload referring to external arrays, which are kept valid by owner
+   static std::shared_ptr<cf_xmlPayload> make_external(std::shared_ptr<const void> owner, size_t stride,
+                                                       cf_xmlArray<double> values,
+                                                       cf_xmlArray<uint32_t> face_row,
+                                                       cf_xmlArray<uint32_t> face_ind);
+
+   // read the content of an element, the parser is positioned at its START_ELEMENT
+   // and is left at the matching END_ELEMENT
+   void read(cf_xmlPullParser& parser);
+
+   // read compact encoded content of <vertices> or <faces>, throws std::logic_error on error
+   void read_encoded(std::string_view tag, std::string_view encoding, size_t count, std::string_view content);
+
+   // set content from numbers read by another front end, such as cf_xmlJson. <vertices> and
+   // <faces> values are as for compact encoded content, <tmatrix> has 4 values per row.
+   // count is the number of vertices, faces or rows. Throws std::logic_error on error
+   void assign(std::string_view tag, size_t count, std::vector<double>& values);
+
+   // number of values per <vertex> or <trow> record
+   size_t stride() const { return m_stride; }
+   cf_xmlArray<double> values() const { return m_v_values; }
+
+   // faces
+   size_t f_size() const { return (m_v_face_row.size() > 0)? m_v_face_row.size()-1 : 0; }
+   void   f_get(size_t f_ind, std::vector<size_t>& indices) const;
+
+   // face i uses face_ind()[face_row()[i] .. face_row()[i+1]>
+   cf_xmlArray<uint32_t> face_row() const { return m_v_face_row; }
+   cf_xmlArray<uint32_t> face_ind() const { return m_v_face_ind; }
+
+private:
+   void read_records(cf_xmlPullParser& parser, std::string_view record_tag, const std::vector<std::string_view>& names);
+   void read_faces(cf_xmlPullParser& parser);
+   void read_encoded(cf_xmlPullParser& parser, std::string_view encoding);
+   void set_vertices(size_t count, std::vector<double>& values);
+   void set_faces(size_t count, const std::vector<uint32_t>& values);
+
+   // release unused capacity and let the views refer to the owned arrays
+   void finish();
+
+   cf_xmlPayload(const cf_xmlPayload&) = delete;
+   cf_xmlPayload& operator=(const cf_xmlPayload&) = delete;
+
+private:
+   size_t                m_stride;
+   std::vector<double>   m_values;    // owned arrays
+   std::vector<uint32_t> m_face_row;
+   std::vector<uint32_t> m_face_ind;
+
+   std::shared_ptr<const void> m_owner;  // owner of external arrays
+   cf_xmlArray<double>   m_v_values;     // views of owned or external arrays
+   cf_xmlArray<uint32_t> m_v_face_row;
+   cf_xmlArray<uint32_t> m_v_face_ind;
+};
+
+// registry of payloads referred to by tree nodes, payloads are owned by the cf_xmlTree that read them
+class cf_xmlPayloadRegistry {
+public:
+   static cf_xmlPayloadRegistry& singleton()
+   {
+      static cf_xmlPayloadRegistry instance;
+      return instance;
+   }
+
+   // add payload and return its id
+   size_t add(std::shared_ptr<const cf_xmlPayload> payload);
+
+   // return payload with given id, nullptr if not found
+   std::shared_ptr<const cf_xmlPayload> get(size_t id) const;
+
+   void remove(size_t id);
+
+private:
+   cf_xmlPayloadRegistry();
+   virtual ~cf_xmlPayloadRegistry();
+
+private:
+   mutable std::mutex  m_mutex;
+   size_t              m_next_id;
+   std::map<size_t,std::shared_ptr<const cf_xmlPayload>> m_payloads;
+};
+
+#endif // CF_XMLPAYLOAD_H
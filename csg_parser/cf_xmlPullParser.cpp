@@ -0,0 +1,247 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "cf_xmlPullParser.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+static inline bool is_space(char c)
+{
+   return (c==' ' || c=='\t' || c=='\n' || c=='\r');
+}
+
+static std::string_view trim_view(std::string_view s)
+{
+   while(s.size() > 0 && is_space(s.front())) s.remove_prefix(1);
+   while(s.size() > 0 && is_space(s.back()))  s.remove_suffix(1);
+   return s;
+}
+
+cf_xmlPullParser::cf_xmlPullParser(const char* begin, const char* end)
+: m_begin(begin)
+, m_pos(begin)
+, m_end(end)
+, m_pending_end(false)
+{
+   // skip UTF-8 byte order mark
+   if(m_end-m_pos >= 3 && std::memcmp(m_pos,"\xEF\xBB\xBF",3)==0) m_pos += 3;
+}
+
+cf_xmlPullParser::~cf_xmlPullParser()
+{}
+
+bool cf_xmlPullParser::starts_with(const char* s) const
+{
+   size_t n = std::strlen(s);
+   return (size_t(m_end-m_pos) >= n) && (std::memcmp(m_pos,s,n) == 0);
+}
+
+void cf_xmlPullParser::skip_past(const char* s)
+{
+   const char* found = std::search(m_pos,m_end,s,s+std::strlen(s));
+   if(found == m_end) error("unterminated markup, expected '" + std::string(s) + "'");
+   m_pos = found + std::strlen(s);
+}
+
+void cf_xmlPullParser::skip_whitespace()
+{
+   while(m_pos<m_end && is_space(*m_pos)) m_pos++;
+}
+
+std::string_view cf_xmlPullParser::read_name()
+{
+   const char* start = m_pos;
+   while(m_pos<m_end && !is_space(*m_pos) && *m_pos!='/' && *m_pos!='>' && *m_pos!='=') m_pos++;
+   if(m_pos == start) error("expected a name");
+   return std::string_view(start,m_pos-start);
+}
+
+cf_xmlPullParser::event_type cf_xmlPullParser::next()
+{
+   if(m_pending_end) {
+      m_pending_end = false;
+      m_open.pop_back();
+      return END_ELEMENT;
+   }
+
+   while(true) {
+
+      if(m_pos == m_end) {
+         if(m_open.size() > 0) error("unexpected end of document, missing </" + std::string(m_open.back()) + ">");
+         return END_DOCUMENT;
+      }
+
+      if(*m_pos != '<') {
+         const char* start = m_pos;
+         m_pos = std::find(m_pos,m_end,'<');
+         m_text = std::string_view(start,m_pos-start);
+         if(m_open.size() > 0) return TEXT;
+         if(trim_view(m_text).size() > 0) error("text outside of root element");
+         continue;
+      }
+
+      if(starts_with("<!--")) {
+         skip_past("-->");
+      }
+      else if(starts_with("<![CDATA[")) {
+         m_pos += 9;
+         const char* start = m_pos;
+         skip_past("]]>");
+         m_text = std::string_view(start,(m_pos-3)-start);
+         if(m_open.size() > 0) return TEXT;
+         if(trim_view(m_text).size() > 0) error("CDATA outside of root element");
+      }
+      else if(starts_with("<?")) {
+         skip_past("?>");
+      }
+      else if(starts_with("<!")) {
+         // DOCTYPE, possibly with an internal subset in brackets
+         int depth = 0;
+         for(m_pos+=2; m_pos<m_end; m_pos++) {
+            if(*m_pos == '[') depth++;
+            else if(*m_pos == ']') depth--;
+            else if(*m_pos == '>' && depth <= 0) break;
+         }
+         if(m_pos == m_end) error("unterminated DOCTYPE");
+         m_pos++;
+      }
+      else if(starts_with("</")) {
+         m_pos += 2;
+         m_tag = read_name();
+         skip_whitespace();
+         if(m_pos == m_end || *m_pos != '>') error("expected '>' after </" + std::string(m_tag));
+         m_pos++;
+         if(m_open.size() == 0 || m_open.back() != m_tag) {
+            std::string expected = (m_open.size() > 0)? "</" + std::string(m_open.back()) + ">" : "no end tag";
+            error("mismatched </" + std::string(m_tag) + ">, expected " + expected);
+         }
+         m_open.pop_back();
+         return END_ELEMENT;
+      }
+      else {
+         m_pos++;
+         m_tag = read_name();
+         m_attributes.clear();
+         while(true) {
+            skip_whitespace();
+            if(m_pos == m_end) error("unterminated start tag <" + std::string(m_tag));
+            if(*m_pos == '>') {
+               m_pos++;
+               break;
+            }
+            if(*m_pos == '/') {
+               if(m_end-m_pos < 2 || m_pos[1] != '>') error("expected '/>' in <" + std::string(m_tag));
+               m_pos += 2;
+               m_pending_end = true;
+               break;
+            }
+            std::string_view name = read_name();
+            skip_whitespace();
+            if(m_pos == m_end || *m_pos != '=') error("expected '=' after attribute " + std::string(name));
+            m_pos++;
+            skip_whitespace();
+            if(m_pos == m_end || (*m_pos != '"' && *m_pos != '\'')) error("expected quoted value for attribute " + std::string(name));
+            char quote = *m_pos++;
+            const char* start = m_pos;
+            m_pos = std::find(m_pos,m_end,quote);
+            if(m_pos == m_end) error("unterminated value for attribute " + std::string(name));
+            m_attributes.push_back(attribute(name,std::string_view(start,m_pos-start)));
+            m_pos++;
+         }
+         m_open.push_back(m_tag);
+         return START_ELEMENT;
+      }
+   }
+}
+
+bool cf_xmlPullParser::attribute_value(std::string_view name, std::string_view& value) const
+{
+   for(auto& a : m_attributes) {
+      if(a.first == name) {
+         value = a.second;
+         return true;
+      }
+   }
+   return false;
+}
+
+size_t cf_xmlPullParser::line() const
+{
+   return 1 + std::count(m_begin,m_pos,'\n');
+}
+
+void cf_xmlPullParser::error(const std::string& message) const
+{
+   throw std::logic_error("xml parse error at line " + std::to_string(line()) + ": " + message);
+}
+
+std::string cf_xmlPullParser::decode(std::string_view raw)
+{
+   std::string result;
+   result.reserve(raw.size());
+   size_t i = 0;
+   while(i < raw.size()) {
+      if(raw[i] == '&') {
+         size_t semi = raw.find(';',i);
+         if(semi != std::string_view::npos) {
+            std::string_view ent = raw.substr(i+1,semi-i-1);
+            bool known = true;
+            if(ent == "lt")        result += '<';
+            else if(ent == "gt")   result += '>';
+            else if(ent == "amp")  result += '&';
+            else if(ent == "quot") result += '"';
+            else if(ent == "apos") result += '\'';
+            else if(ent.size() > 1 && ent[0] == '#') {
+               // numeric character reference, encoded as UTF-8
+               unsigned long cp = 0;
+               bool hex = (ent[1] == 'x' || ent[1] == 'X');
+               const char* first = ent.data() + (hex? 2 : 1);
+               auto res = std::from_chars(first,ent.data()+ent.size(),cp,hex? 16 : 10);
+               if(res.ec != std::errc() || res.ptr != ent.data()+ent.size()) known = false;
+               else if(cp < 0x80)    { result += char(cp); }
+               else if(cp < 0x800)   { result += char(0xC0|(cp>>6));  result += char(0x80|(cp&0x3F)); }
+               else if(cp < 0x10000) { result += char(0xE0|(cp>>12)); result += char(0x80|((cp>>6)&0x3F)); result += char(0x80|(cp&0x3F)); }
+               else                  { result += char(0xF0|(cp>>18)); result += char(0x80|((cp>>12)&0x3F)); result += char(0x80|((cp>>6)&0x3F)); result += char(0x80|(cp&0x3F)); }
+            }
+            else known = false;
+
+            if(known) {
+               i = semi+1;
+               continue;
+            }
+         }
+      }
+      result += raw[i++];
+   }
+   return result;
+}
+
+bool cf_xmlPullParser::to_double(std::string_view raw, double& value)
+{
+   raw = trim_view(raw);
+   if(raw.size() > 0 && raw[0] == '+') raw.remove_prefix(1);
+   auto res = std::from_chars(raw.data(),raw.data()+raw.size(),value);
+   return (raw.size() > 0) && (res.ec == std::errc()) && (res.ptr == raw.data()+raw.size());
+}
+
+bool cf_xmlPullParser::to_long(std::string_view raw, long long& value)
+{
+   raw = trim_view(raw);
+   if(raw.size() > 0 && raw[0] == '+') raw.remove_prefix(1);
+   auto res = std::from_chars(raw.data(),raw.data()+raw.size(),value);
+   return (raw.size() > 0) && (res.ec == std::errc()) && (res.ptr == raw.data()+raw.size());
+}
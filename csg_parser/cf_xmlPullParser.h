@@ -0,0 +1,83 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef CF_XMLPULLPARSER_H
+#define CF_XMLPULLPARSER_H
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// cf_xmlPullParser is a minimal, non-validating pull parser for xml text in memory.
+// next() advances to the next event. Tags, attribute values and text are views into
+// the input buffer, which must outlive the parser. Entity references are not decoded
+// in the views, use decode(...) where required. Comments, processing instructions
+// and DOCTYPE declarations are skipped. Syntax errors throw std::logic_error.
+
+class cf_xmlPullParser {
+public:
+   enum event_type { START_ELEMENT, END_ELEMENT, TEXT, END_DOCUMENT };
+   typedef std::pair<std::string_view,std::string_view> attribute;
+
+   cf_xmlPullParser(const char* begin, const char* end);
+   virtual ~cf_xmlPullParser();
+
+   // advance to the next event. A self closing element returns START_ELEMENT followed by END_ELEMENT
+   event_type next();
+
+   // tag of current START_ELEMENT or END_ELEMENT
+   std::string_view tag() const { return m_tag; }
+
+   // raw text of current TEXT event, not trimmed
+   std::string_view text() const { return m_text; }
+
+   // attributes of current START_ELEMENT, in document order
+   const std::vector<attribute>& attributes() const { return m_attributes; }
+
+   // return raw attribute value of current START_ELEMENT, false if not present
+   bool attribute_value(std::string_view name, std::string_view& value) const;
+
+   // line number of the current position, for error messages
+   size_t line() const;
+
+   // throw std::logic_error with line number
+   [[noreturn]] void error(const std::string& message) const;
+
+   // decode entity references in raw text or attribute value
+   static std::string decode(std::string_view raw);
+
+   // parse numbers in place, surrounding whitespace is allowed. Return false if not a valid number
+   static bool to_double(std::string_view raw, double& value);
+   static bool to_long(std::string_view raw, long long& value);
+
+private:
+   bool starts_with(const char* s) const;
+   void skip_past(const char* s);
+   void skip_whitespace();
+   std::string_view read_name();
+
+private:
+   const char*  m_begin;
+   const char*  m_pos;
+   const char*  m_end;
+   bool         m_pending_end;          // self closing element, END_ELEMENT is next
+   std::string_view              m_tag;
+   std::string_view              m_text;
+   std::vector<attribute>        m_attributes;
+   std::vector<std::string_view> m_open;  // open elements, to check nesting
+};
+
+#endif // CF_XMLPULLPARSER_H
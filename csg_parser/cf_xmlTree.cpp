@@ -14,18 +14,39 @@
 // EndLicense:
 
 #include "cf_xmlTree.h"
+#include "cf_xmlBinary.h"
+#include "cf_xmlJson.h"
+#include "cf_xmlPayload.h"
+#include "cf_xmlPullParser.h"
+#include <charconv>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
 cf_xmlTree::cf_xmlTree()
+: m_compact(false)
 {}
 
 cf_xmlTree::~cf_xmlTree()
-{}
+{
+   clear_payloads();
+}
+
+void cf_xmlTree::clear_payloads()
+{
+   for(size_t id : m_payloads) cf_xmlPayloadRegistry::singleton().remove(id);
+   m_payloads.clear();
+}
 
 void cf_xmlTree::clear()
 {
+   clear_payloads();
    m_tree.clear();
    m_root_name = "";
 }
@@ -51,9 +72,107 @@ bool cf_xmlTree::get_root(cf_xmlNode& root)
    return false;
 }
 
+static void append_number(string& text, double value)
+{
+   char buf[32];
+   auto res = std::to_chars(buf,buf+sizeof(buf),value);
+   if(text.size() > 0) text += ' ';
+   text.append(buf,res.ptr);
+}
+
+cf_xmlTree::ptree cf_xmlTree::expand_payloads(const string& tag, ptree& node, bool compact)
+{
+   // payloads, and compact encoded content when writing the element form
+   std::shared_ptr<const cf_xmlPayload> payload;
+   if(cf_xmlPayload::is_payload(tag) && (node.find("<xmlpayload>") != node.not_found() || !compact)) {
+      payload = cf_xmlNode(tag,node).payload();
+   }
+
+   if(!payload) {
+      ptree result(node.data());
+      for(auto& child : node) {
+         if(child.first == "<xmlattr>") result.push_back(child);
+         else result.push_back(ptree::value_type(child.first,expand_payloads(child.first,child.second,compact)));
+      }
+      return result;
+   }
+
+   // attributes other than the encoding are kept
+   ptree result;
+   auto attr = node.find("<xmlattr>");
+   if(attr != node.not_found()) {
+      ptree& result_attr = result.push_back(ptree::value_type("<xmlattr>",ptree()))->second;
+      for(auto& a : attr->second) {
+         if(a.first != "count" && a.first != "encoding") result_attr.push_back(a);
+      }
+      if(result_attr.size() == 0) result.clear();
+   }
+
+   cf_xmlArray<double> values = payload->values();
+   if(payload->stride() == 4) {
+      // <tmatrix>
+      for(size_t i=0; i+4<=values.size(); i+=4) {
+         ptree& trow = result.add_child("trow",ptree());
+         for(size_t j=0; j<4; j++) append_number(trow.put("<xmlattr>.c"+std::to_string(j),string()).data(),values[i+j]);
+      }
+   }
+   else if(payload->stride() == 3) {
+      // <vertices>
+      if(compact) {
+         string text;
+         for(double v : values) append_number(text,v);
+         result.put("<xmlattr>.count",values.size()/3);
+         result.put("<xmlattr>.encoding","text");
+         result.data() = text;
+      }
+      else {
+         for(size_t i=0; i+3<=values.size(); i+=3) {
+            ptree& vertex = result.add_child("vertex",ptree());
+            ptree& xyz    = vertex.add_child("<xmlattr>",ptree());
+            append_number(xyz.add("x",string()).data(),values[i]);
+            append_number(xyz.add("y",string()).data(),values[i+1]);
+            append_number(xyz.add("z",string()).data(),values[i+2]);
+         }
+      }
+   }
+   else {
+      // <faces>
+      cf_xmlArray<uint32_t> rows = payload->face_row();
+      cf_xmlArray<uint32_t> ind  = payload->face_ind();
+      if(compact) {
+         string text;
+         for(size_t f=0; f<payload->f_size(); f++) {
+            append_number(text,rows[f+1]-rows[f]);
+            for(uint32_t i=rows[f]; i<rows[f+1]; i++) append_number(text,ind[i]);
+         }
+         result.put("<xmlattr>.count",payload->f_size());
+         result.put("<xmlattr>.encoding","text");
+         result.data() = text;
+      }
+      else {
+         for(size_t f=0; f<payload->f_size(); f++) {
+            ptree& face = result.add_child("face",ptree());
+            for(uint32_t i=rows[f]; i<rows[f+1]; i++) {
+               append_number(face.add_child("fv",ptree()).add_child("<xmlattr>",ptree()).add("index",string()).data(),ind[i]);
+            }
+         }
+      }
+   }
+   return result;
+}
+
+void cf_xmlTree::set_compact(bool compact)
+{
+   m_compact = compact;
+}
+
 bool cf_xmlTree::write_xml(ostream& os)
 {
    os.imbue(std::locale());
+   if(m_payloads.size() > 0 || !m_compact) {
+      boost::property_tree::write_xml(os,expand_payloads("",m_tree,m_compact),boost::property_tree::xml_writer_make_settings<std::string>('\t', 1));
+      return true;
+   }
    boost::property_tree::write_xml(os,m_tree,boost::property_tree::xml_writer_make_settings<std::string>('\t', 1));
    return true;
 }
@@ -66,6 +185,7 @@ bool cf_xmlTree::write_xml(const string& path)
 
 bool cf_xmlTree::read_xml(istream& is)
 {
+   clear_payloads();
    m_tree = ptree();
    boost::property_tree::read_xml(is,m_tree,boost::property_tree::xml_parser::trim_whitespace);
    if(m_tree.size() == 1) {
@@ -85,6 +205,116 @@ bool cf_xmlTree::read_xml(const string& path)
    return false;
 }
 
+// parse the memory mapped text of a file, empty files cannot be mapped and are parsed as empty text
+static bool parse_mapped(const string& path, const std::function<bool(const char*,const char*)>& parse)
+{
+   if(!boost::filesystem::is_regular_file(path)) return false;
+   if(boost::filesystem::file_size(path) == 0) return parse(nullptr,nullptr);
+
+   boost::interprocess::file_mapping  file(path.c_str(),boost::interprocess::read_only);
+   boost::interprocess::mapped_region region(file,boost::interprocess::read_only);
+   const char* begin = static_cast<const char*>(region.get_address());
+   return parse(begin,begin+region.get_size());
+}
+
+bool cf_xmlTree::read_xcsg(const string& path)
+{
+   return parse_mapped(path,[this](const char* begin, const char* end) { return parse_xcsg(begin,end); });
+}
+
+bool cf_xmlTree::read_xcsg(istream& is)
+{
+   const string text((std::istreambuf_iterator<char>(is)),std::istreambuf_iterator<char>());
+   return parse_xcsg(text.data(),text.data()+text.size());
+}
+
+bool cf_xmlTree::parse_xcsg(const char* begin, const char* end)
+{
+   clear_payloads();
+   m_tree = ptree();
+
+   cf_xmlPullParser parser(begin,end);
+   std::vector<ptree*> open;
+   bool done = false;
+   while(!done) {
+      switch(parser.next()) {
+         case cf_xmlPullParser::START_ELEMENT:
+         {
+            ptree& parent = (open.size() > 0)? *open.back() : m_tree;
+            if(open.size() == 0 && m_tree.size() > 0) parser.error("more than one root element");
+
+            ptree& node = parent.push_back(ptree::value_type(string(parser.tag()),ptree()))->second;
+            if(parser.attributes().size() > 0) {
+               ptree& attr = node.push_back(ptree::value_type("<xmlattr>",ptree()))->second;
+               for(auto& a : parser.attributes()) {
+                  attr.push_back(ptree::value_type(string(a.first),ptree(cf_xmlPullParser::decode(a.second))));
+               }
+            }
+
+            if(open.size() > 0 && cf_xmlPayload::is_payload(parser.tag())) {
+               // the payload element is complete after this
+               auto payload = std::make_shared<cf_xmlPayload>();
+               payload->read(parser);
+               size_t id = cf_xmlPayloadRegistry::singleton().add(payload);
+               m_payloads.push_back(id);
+               node.push_back(ptree::value_type("<xmlpayload>",ptree(std::to_string(id))));
+            }
+            else {
+               open.push_back(&node);
+            }
+            break;
+         }
+         case cf_xmlPullParser::END_ELEMENT:
+         {
+            open.pop_back();
+            break;
+         }
+         case cf_xmlPullParser::TEXT:
+         {
+            // whitespace is trimmed, as with read_xml
+            string value = cf_xmlPullParser::decode(parser.text());
+            size_t first = value.find_first_not_of(" \t\r\n");
+            if(first != string::npos) {
+               size_t last = value.find_last_not_of(" \t\r\n");
+               open.back()->data() += value.substr(first,last-first+1);
+            }
+            break;
+         }
+         case cf_xmlPullParser::END_DOCUMENT:
+         {
+            done = true;
+            break;
+         }
+      };
+   }
+
+   if(m_tree.size() == 1) {
+      ptree::iterator i=m_tree.begin();
+      m_root_name = i->first;
+      return true;
+   }
+   return false;
+}
+
+bool cf_xmlTree::write_binary(const string& path)
+{
+   cf_xmlBinary::write(m_tree,path);
+   return true;
+}
+
+bool cf_xmlTree::read_binary(const string& path)
+{
+   clear_payloads();
+   m_tree = ptree();
+   cf_xmlBinary::read(path,m_tree,m_payloads);
+   if(m_tree.size() == 1) {
+      ptree::iterator i=m_tree.begin();
+      m_root_name = i->first;
+      return true;
+   }
+   return false;
+}
+
 bool cf_xmlTree::write_json(ostream& os, bool pretty)
 {
    os.imbue(std::locale());
@@ -101,6 +331,7 @@ bool cf_xmlTree::write_json(const string& path, bool pretty)
 
 bool cf_xmlTree::read_json(istream& is)
 {
+   clear_payloads();
    m_tree = ptree();
    boost::property_tree::read_json(is,m_tree);
    if(m_tree.size() == 1) {
@@ -119,3 +350,28 @@ bool cf_xmlTree::read_json(const string& path)
    }
    return false;
 }
+
+bool cf_xmlTree::read_xcsg_json(const string& path)
+{
+   return parse_mapped(path,[this](const char* begin, const char* end) { return parse_xcsg_json(begin,end); });
+}
+
+bool cf_xmlTree::read_xcsg_json(istream& is)
+{
+   const string text((std::istreambuf_iterator<char>(is)),std::istreambuf_iterator<char>());
+   return parse_xcsg_json(text.data(),text.data()+text.size());
+}
+
+bool cf_xmlTree::parse_xcsg_json(const char* begin, const char* end)
+{
+   clear_payloads();
+   m_tree = ptree();
+
+   cf_xmlJson::read(begin,end,m_tree,m_payloads);
+   if(m_tree.size() == 1) {
+      ptree::iterator i=m_tree.begin();
+      m_root_name = i->first;
+      return true;
+   }
+   return false;
+}
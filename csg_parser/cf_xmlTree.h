@@ -23,6 +23,7 @@
 
 #include <ostream>
 #include <string>
+#include <vector>
 using namespace std;
 #include <boost/property_tree/ptree.hpp>
 
@@ -43,6 +44,10 @@ public:
    // return the root node of the tree, if it exists
    bool get_root(cf_xmlNode& root);
 
+   // <vertices> and <faces> are written with one element per vertex and face, readable by
+   // all xcsg versions. With compact=true they are written in compact text encoding instead
+   void set_compact(bool compact);
+
    // write xml data to any output stream
    bool write_xml(ostream& os);
 
@@ -55,6 +60,22 @@ public:
    // read xml data from file
    bool read_xml(const string& path);
 
+   // read xml data from file with the pull parser. Attributes and structure are stored as
+   // with read_xml, but <vertices>, <faces> and <tmatrix> content is parsed directly into
+   // payloads, see cf_xmlPayload. write_xml writes payloads as set by set_compact.
+   bool read_xcsg(const string& path);
+
+   // as above, from any input stream
+   bool read_xcsg(istream& is);
+
+   // === binary .xcsgb export/import, see cf_xmlBinary
+
+   // write binary data to file
+   bool write_binary(const string& path);
+
+   // read binary data from memory mapped file, payloads refer directly to the mapped data
+   bool read_binary(const string& path);
+
    // === JSON export/import
 
    // write json data to any output stream, set pretty=false to make a compact file
@@ -69,9 +90,29 @@ public:
    // read json data from any file
    bool read_json(const string& path);
 
+   // read .xcsg.json file in a single pass, see cf_xmlJson. Numeric rows of
+   // <vertices>, <faces> and <tmatrix> are parsed directly into payloads as with read_xcsg
+   bool read_xcsg_json(const string& path);
+
+   // as above, from any input stream
+   bool read_xcsg_json(istream& is);
+
+private:
+   // release the payloads of this tree
+   void clear_payloads();
+
+   // parse .xcsg and .xcsg.json text, see read_xcsg and read_xcsg_json
+   bool parse_xcsg(const char* begin, const char* end);
+   bool parse_xcsg_json(const char* begin, const char* end);
+
+   // copy of node with payloads, and compact encoded content unless compact, expanded to xml content
+   static ptree expand_payloads(const string& tag, ptree& node, bool compact);
+
 private:
    string  m_root_name;
    ptree   m_tree;
+   std::vector<size_t> m_payloads;  // payload registry ids
+   bool    m_compact;                // write_xml compact text encoding
 };
 
 #endif // cf_xmlTree_H
@@ -0,0 +1,104 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "csg_array.h"
+#include "csg_scalar.h"
+#include <charconv>
+#include <stdexcept>
+
+static inline const char* skip_space(const char* p, const char* end)
+{
+   while(p<end && (*p==' ' || *p=='\t' || *p=='\r' || *p=='\n')) p++;
+   return p;
+}
+
+// parse "a,b,c]" and append the values, return position after ']' or nullptr if not numeric
+static const char* parse_numbers(const char* p, const char* end, std::vector<double>& values)
+{
+   p = skip_space(p,end);
+   if(p<end && *p==']') return p+1;
+   while(p<end) {
+      double value = 0.0;
+      auto res = std::from_chars(p,end,value);
+      if(res.ec != std::errc()) return nullptr;
+      values.push_back(value);
+      p = skip_space(res.ptr,end);
+      if(p == end) return nullptr;
+      if(*p == ']') return p+1;
+      if(*p != ',') return nullptr;
+      p = skip_space(p+1,end);
+   }
+   return nullptr;
+}
+
+csg_array::csg_array(size_t line_no)
+: csg_value(line_no)
+{}
+
+csg_array::~csg_array()
+{}
+
+std::shared_ptr<csg_array> csg_array::parse(std::string_view text, size_t line_no)
+{
+   const char* p   = text.data();
+   const char* end = p + text.size();
+
+   p = skip_space(p,end);
+   if(p==end || *p!='[') return nullptr;
+   p = skip_space(p+1,end);
+
+   auto array = std::make_shared<csg_array>(line_no);
+   if(p<end && *p=='[') {
+      // vector of vectors
+      array->m_rows.push_back(0);
+      while(true) {
+         p = parse_numbers(p+1,end,array->m_values);
+         if(!p) return nullptr;
+         array->m_rows.push_back(array->m_values.size());
+
+         p = skip_space(p,end);
+         if(p == end) return nullptr;
+         if(*p == ']') { p++; break; }
+         if(*p != ',') return nullptr;
+         p = skip_space(p+1,end);
+         if(p==end || *p!='[') return nullptr;
+      }
+   }
+   else {
+      p = parse_numbers(p,end,array->m_values);
+      if(!p) return nullptr;
+   }
+
+   if(skip_space(p,end) != end) return nullptr;
+   return array;
+}
+
+std::shared_ptr<csg_value> csg_array::get(size_t i) const
+{
+   if(i >= size()) throw std::runtime_error("csg_array::get(), index out of bounds");
+
+   if(m_rows.size() == 0) return std::make_shared<csg_scalar>(format(m_values[i]),line_no());
+
+   auto row_array = std::make_shared<csg_array>(line_no());
+   row_array->m_values.assign(row(i),row(i)+row_size(i));
+   return row_array;
+}
+
+std::string csg_array::format(double value)
+{
+   char buf[32];
+   auto res = std::to_chars(buf,buf+sizeof(buf),value);
+   return std::string(buf,res.ptr);
+}
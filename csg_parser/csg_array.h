@@ -0,0 +1,62 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef CSG_ARRAY_H
+#define CSG_ARRAY_H
+
+#include "csg_value.h"
+#include <string_view>
+#include <vector>
+
+// a numeric vector parameter value in a csg node, such as polyhedron points and faces.
+// The numbers are stored in one flat buffer, for a vector of vectors (rank 2) the rows
+// are given by offsets into the buffer
+class csg_array : public csg_value {
+public:
+   csg_array(size_t line_no);
+   virtual ~csg_array();
+
+   // parse a [...] or [[...],...] numeric literal in a single pass.
+   // Returns nullptr if the text is not a numeric vector of rank 1 or 2
+   static std::shared_ptr<csg_array> parse(std::string_view text, size_t line_no);
+
+   virtual bool is_vector() const { return true; }
+   virtual const csg_array* as_array() const { return this; }
+
+   // 1 for a vector of numbers, 2 for a vector of vectors of numbers
+   size_t rank() const { return (m_rows.size() > 0)? 2 : 1; }
+
+   // number of values (rank 1) or rows (rank 2)
+   virtual size_t size() const { return (m_rows.size() > 0)? m_rows.size()-1 : m_values.size(); }
+
+   // returns a scalar (rank 1) or a copy of a row (rank 2)
+   virtual std::shared_ptr<csg_value> get(size_t i) const;
+
+   // rows of a rank 2 array
+   size_t        row_size(size_t i) const { return m_rows[i+1]-m_rows[i]; }
+   const double* row(size_t i) const      { return m_values.data()+m_rows[i]; }
+
+   // all values
+   const std::vector<double>& values() const { return m_values; }
+
+   // shortest text representation of a value
+   static std::string format(double value);
+
+private:
+   std::vector<double> m_values;
+   std::vector<size_t> m_rows;   // row offsets, size()+1 values for rank 2, empty for rank 1
+};
+
+#endif // CSG_ARRAY_H
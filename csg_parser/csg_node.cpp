@@ -17,33 +17,23 @@
 #include <stdio.h>
 #include <stdexcept>
 #include <cmath>
+#include <charconv>
 #include <unordered_set>
 
 #include "csg_node.h"
 #include "csg_scalar.h"
 #include "csg_vector.h"
+#include "csg_array.h"
 
 static const double pi = 4.0*atan(1.0);
 
-
-inline void tokenize(const std::string& input,
-                     const std::string& delimiters,
-                     std::vector<std::string>& tokens)
+// append shortest text form of value followed by separator
+static inline void append_number(std::string& text, double value, char separator)
 {
-   using namespace std;
-   string::size_type last_pos = 0;
-   string::size_type pos = 0;
-   while(true) {
-      pos = input.find_first_of(delimiters, last_pos);
-      if( pos == string::npos ) {
-         if(input.length()-last_pos > 0)tokens.push_back(input.substr(last_pos));
-         break;
-      }
-      else {
-         if(pos-last_pos > 0)tokens.push_back(input.substr(last_pos, pos - last_pos));
-         last_pos = pos + 1;
-      }
-   }
+   char buf[32];
+   auto res = std::to_chars(buf,buf+sizeof(buf),value);
+   text.append(buf,res.ptr);
+   text += separator;
 }
 
 
@@ -149,68 +139,61 @@ void csg_node::build_tree(const std::vector<func_data>& func, size_t& index)
 
 void csg_node::parse_params()
 {
-   std::string type   = tag();
-   std::string params = par();
-
-   // first get rid of the enclosing parentheses
-   std::vector<std::string> tokens;
-   tokenize(params,"()",tokens);
-   if(tokens.size() > 0) {
-
-      size_t iparam = 0; // parameter counter
-      params = tokens[0];
-
-      // we now have  name1=value1,name2=name2,... where values can be (nested) vectors
-      // but note that in some few cases, the name is missing (multmatrix)
-      while(params.size() > 0) {
-         size_t ieq = params.find_first_of('=');
-         std::string name;
-         if(ieq==std::string::npos) {
-            name = par_name(iparam);  // nameless parameter
-            ieq = 0;
-         }
-         else {
-            // increment ieq to eat equal sign
-            name = params.substr(0,ieq++);
-         }
+   // the parameters are enclosed in the outer parentheses
+   size_t ibeg = m_func.find_first_of('(');
+   size_t iend = m_func.find_last_of(')');
+   if(ibeg == std::string::npos || iend == std::string::npos || iend <= ibeg) return;
+   std::string_view params(m_func.data()+ibeg+1,iend-ibeg-1);
+
+   // we now have  name1=value1,name2=name2,... where values can be (nested) vectors
+   // but note that in some few cases, the name is missing (multmatrix)
+   size_t iparam = 0; // nameless parameter counter
+   size_t ipos   = 0;
+   while(ipos < params.size()) {
+      std::string name;
+      size_t ieq = params.find_first_of("=[,\"",ipos);
+      if(ieq==std::string::npos || params[ieq]!='=') {
+         name = par_name(iparam++);  // nameless parameter
+      }
+      else {
+         // the value follows the equal sign
+         name = std::string(params.substr(ipos,ieq-ipos));
+         ipos = ieq+1;
+      }
 
-         // extract value, parse it and assign it to parameter map
-         std::string value_str = par_value(params,ieq);
-         std::shared_ptr<csg_value> value = csg_value::parse(value_str,m_line_no);
-         if(value.get()) m_par[name] = value;
+      // extract value, parse it and assign it to parameter map
+      size_t ivend = par_value(params,ipos);
+      std::shared_ptr<csg_value> value = csg_value::parse(params.substr(ipos,ivend-ipos),m_line_no);
+      if(value.get()) m_par[name] = value;
 
-         // truncate the parameter list from left
-         size_t len = name.length()+1 + value_str.length()+1;
-         params = (len <= params.size()) ? params.substr(len) : "";
-      }
+      // skip the comma separating the parameters
+      ipos = (ivend < params.size() && params[ivend]==',')? ivend+1 : ivend;
    }
 }
 
-// find the next value substring in the parameter list
-// Make sure to account for (nested) vectors using [] characters
+// find the end of the value starting at istart in the parameter list
+// Make sure to account for (nested) vectors using [] characters and quoted strings
 // we essentially search for end of vector ']', next comma or end of string
-// if we find a comma, we replace it with a blank
-std::string csg_node::par_value(std::string& param, size_t istart)
+size_t csg_node::par_value(std::string_view params, size_t istart)
 {
-   std::string value;
    size_t inside = 0;
-   for(size_t i=istart; i<param.size(); i++) {
-      char c = param[i];
+   bool   quoted = false;
+   for(size_t i=istart; i<params.size(); i++) {
+      char c = params[i];
+      if(c == '"') quoted = !quoted;
+      if(quoted) continue;
       if(c == '[') inside++;        // vector begins
       if(c == ',' && inside==0) {   // next parameter
-         param[i] = ' ';
-         break;
+         return i;
       }
-      if(c == ']') {                // vector ends
+      if(c == ']' && inside > 0) {  // vector ends
          inside--;
          if(inside==0) {            // outer vector ends
-            value += c;
-            break;
+            return i+1;
          }
       }
-      value += c;
    }
-   return value;
+   return params.size();
 }
 
 void  csg_node::dump()
@@ -666,36 +649,71 @@ cf_xmlNode csg_node::to_xcsg(cf_xmlNode& parent)
                auto points = get_value("points");
                size_t np    = points->size();
                if(np<4)  throw std::runtime_error(line_no + ": polyhedron with too few points: "+ par());
-               cf_xmlNode xml_vertices = xml_this.add_child("vertices");
-               for(size_t ip=0; ip<np; ip++) {
-                  auto point = points->get(ip);
-                  if(point->size()==1) {
-                     throw std::runtime_error(line_no +": Illegal polyhedron point value at position("+std::to_string(ip)+"): "+point->to_string() );
+               // vertices and faces are stored in compact text encoding, see cf_xmlPayload.
+               // cf_xmlTree::write_xml writes them as elements unless compact output is requested
+               std::string vertex_text;
+               const csg_array* point_array = points->as_array();
+               if(point_array && point_array->rank()==2) {
+                  // numeric points, formatted directly from the parsed values
+                  for(size_t ip=0; ip<np; ip++) {
+                     if(point_array->row_size(ip)<3)  throw std::runtime_error(line_no +": polyhedron points must have 3 values ("+std::to_string(ip)+' ' +std::to_string(point_array->row_size(ip))+"): "+ par());
+                     const double* xyz = point_array->row(ip);
+                     append_number(vertex_text,xyz[0],' ');
+                     append_number(vertex_text,xyz[1],' ');
+                     append_number(vertex_text,xyz[2],'\n');
                   }
-                  if(point->size()<3)  throw std::runtime_error(line_no +": polyhedron points must have 3 values ("+std::to_string(ip)+' ' +std::to_string(point->size())+"): "+ par());
+               }
+               else {
+                  for(size_t ip=0; ip<np; ip++) {
+                     auto point = points->get(ip);
+                     if(point->size()==1) {
+                        throw std::runtime_error(line_no +": Illegal polyhedron point value at position("+std::to_string(ip)+"): "+point->to_string() );
+                     }
+                     if(point->size()<3)  throw std::runtime_error(line_no +": polyhedron points must have 3 values ("+std::to_string(ip)+' ' +std::to_string(point->size())+"): "+ par());
 
-                  cf_xmlNode xml_vertex = xml_vertices.add_child("vertex");
-                  xml_vertex.add_property("x",point->get(0)->to_string());
-                  xml_vertex.add_property("y",point->get(1)->to_string());
-                  xml_vertex.add_property("z",point->get(2)->to_string());
+                     vertex_text += point->get(0)->to_string() + ' ' + point->get(1)->to_string() + ' ' + point->get(2)->to_string() + '\n';
+                  }
                }
+               cf_xmlNode xml_vertices = xml_this.add_child("vertices");
+               xml_vertices.add_property("count",np);
+               xml_vertices.add_property("encoding","text");
+               xml_vertices.put_value(vertex_text);
 
                // Handle face list with variable number of vertices
                auto faces  = get_value("faces");
                if(faces.get()) {
-                  cf_xmlNode xml_faces = xml_this.add_child("faces");
+                  std::string face_text;
                   size_t nf = faces->size();
-                  for(size_t iface=0; iface<nf; iface++) {
-                     auto face = faces->get(iface);
-                     cf_xmlNode xml_face = xml_faces.add_child("face");
-                     size_t nfv=face->size();
-                     if(nfv<3)  throw std::runtime_error(line_no +": polyhedron face must have 3 or more values: "+ par());
-                     for(size_t ifv=0; ifv<nfv; ifv++) {
-                        cf_xmlNode xml_fv = xml_face.add_child("fv");
-                        // openscad face vertex order is reversed, so fix it
-                        xml_fv.add_property("index",face->get(nfv-ifv-1)->to_string());
+                  const csg_array* face_array = faces->as_array();
+                  if(face_array && face_array->rank()==2) {
+                     for(size_t iface=0; iface<nf; iface++) {
+                        size_t nfv = face_array->row_size(iface);
+                        if(nfv<3)  throw std::runtime_error(line_no +": polyhedron face must have 3 or more values: "+ par());
+                        append_number(face_text,double(nfv),' ');
+                        const double* fv = face_array->row(iface);
+                        for(size_t ifv=0; ifv<nfv; ifv++) {
+                           // openscad face vertex order is reversed, so fix it
+                           append_number(face_text,fv[nfv-ifv-1],(ifv+1<nfv)? ' ' : '\n');
+                        }
                      }
                   }
+                  else {
+                     for(size_t iface=0; iface<nf; iface++) {
+                        auto face = faces->get(iface);
+                        size_t nfv=face->size();
+                        if(nfv<3)  throw std::runtime_error(line_no +": polyhedron face must have 3 or more values: "+ par());
+                        face_text += std::to_string(nfv);
+                        for(size_t ifv=0; ifv<nfv; ifv++) {
+                           // openscad face vertex order is reversed, so fix it
+                           face_text += ' ' + face->get(nfv-ifv-1)->to_string();
+                        }
+                        face_text += '\n';
+                     }
+                  }
+                  cf_xmlNode xml_faces = xml_this.add_child("faces");
+                  xml_faces.add_property("count",nf);
+                  xml_faces.add_property("encoding","text");
+                  xml_faces.put_value(face_text);
                }
             }
             else if(xcsg_tag=="projection2d") {
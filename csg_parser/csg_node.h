@@ -17,6 +17,7 @@
 #define CSG_NODE_H
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
 #include <map>
@@ -74,7 +75,7 @@ protected:
    // helpers to buuild csg tree, parse node parameters etc
    void build_tree(const std::vector<func_data>& func, size_t& index);
    void parse_params();
-   std::string par_value(std::string& param, size_t istart);
+   static size_t par_value(std::string_view params, size_t istart);
 
    void dump();
 
@@ -17,22 +17,38 @@
 #include <sstream>
 #include <vector>
 #include <iomanip>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 csg_parser::csg_parser(std::istream& csg, double secant_tolerance)
-: m_root(std::make_shared<csg_node>())
-, m_secant_tolerance(secant_tolerance)
+: m_secant_tolerance(secant_tolerance)
+, m_root(std::make_shared<csg_node>())
 {
    // read the whole file into a string
    std::ostringstream sstr;
    sstr << csg.rdbuf();
-   init_func(sstr.str());
+   const std::string text = sstr.str();
+   init_func(text.data(),text.data()+text.size());
    // m_root->dump();
 }
 
+csg_parser::csg_parser(const std::string& path, double secant_tolerance)
+: m_secant_tolerance(secant_tolerance)
+, m_root(std::make_shared<csg_node>())
+{
+   if(boost::filesystem::file_size(path) == 0) throw std::runtime_error("csg tree has 0 elements!");
+
+   boost::interprocess::file_mapping  file(path.c_str(),boost::interprocess::read_only);
+   boost::interprocess::mapped_region region(file,boost::interprocess::read_only);
+   const char* begin = static_cast<const char*>(region.get_address());
+   init_func(begin,begin+region.get_size());
+}
+
 csg_parser::~csg_parser()
 {}
 
-void csg_parser::init_func(const std::string& csg)
+void csg_parser::init_func(const char* begin, const char* end)
 {
    std::vector<func_data>   func;  // function calls, by function index
 
@@ -42,16 +58,16 @@ void csg_parser::init_func(const std::string& csg)
    size_t level = 0;
    size_t line_no = 1;
 
-   size_t i=0;
-   while(i<csg.size()) {
+   const char* p = begin;
+   while(p < end) {
 
       // get current character
-      char c = csg[i++];
+      char c = *p++;
 
       // Skip // comment line
-      while(c=='/' && csg[i]=='/') {
-         while(csg[++i]!='\n') c = csg[i];
-         c = csg[i];
+      if(c=='/' && p<end && *p=='/') {
+         while(p<end && *p!='\n') p++;
+         continue;
       }
 
       // update the tree level
@@ -64,12 +80,18 @@ void csg_parser::init_func(const std::string& csg)
       }
 
       // characters not contributing to token
-      if( c==' ' || c=='\t' || c=='\n' || c==';' || c=='{' || c=='}' || c=='#') continue;
-
-      // add character to token
-      token += c;
+      if( c==' ' || c=='\t' || c=='\r' || c=='\n' || c==';' || c=='{' || c=='}' || c=='#') continue;
+
+      // add the run of characters up to the next separator or end of function to token
+      const char* run = p-1;
+      while(p<end && c!=')') {
+         c = *p;
+         if( c==' ' || c=='\t' || c=='\r' || c=='\n' || c==';' || c=='{' || c=='}' || c=='#' || c=='/') break;
+         p++;
+      }
+      token.append(run,p);
 
-      if(c==')') {
+      if(token.back()==')') {
          // end of token
          func.push_back(func_data(token,std::make_pair(level,line_no)));
          token.clear();
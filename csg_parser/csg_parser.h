@@ -30,13 +30,17 @@ public:
 
    // parse openscad.csg file and build the openscad tree
    csg_parser(std::istream& csg, double secant_tolerance);
+
+   // as above, reading from memory mapped file
+   csg_parser(const std::string& path, double secant_tolerance);
    virtual ~csg_parser();
 
    // create an xcsg tree
    bool to_xcsg(cf_xmlTree& tree);
 
 protected:
-   void init_func(const std::string& csg);
+   // single pass over the file text, collecting the function calls
+   void init_func(const char* begin, const char* end);
 
 private:
    double                     m_secant_tolerance;
@@ -16,7 +16,9 @@
 #include "csg_value.h"
 #include "csg_scalar.h"
 #include "csg_vector.h"
+#include "csg_array.h"
 #include <stdexcept>
+#include <vector>
 
 csg_value::csg_value(size_t line_no)
 : m_line_no(line_no)
@@ -50,70 +52,67 @@ std::shared_ptr<csg_value> csg_value::get(size_t i) const
    throw std::runtime_error(".csg file line " + std::to_string(m_line_no) +", csg_value::get(), value is not a vector");
 }
 
-std::shared_ptr<csg_value> csg_value::parse(const std::string& value_str, size_t line_no)
+std::shared_ptr<csg_value> csg_value::parse(std::string_view value_str, size_t line_no)
 {
-   std::shared_ptr<csg_value> value;
-
-   // recursively parse the string
-   // when a vector is found [
-   //    call this function again, until corresponding ] is found
-
-   for(size_t i=0; i<value_str.size(); i++) {
-      char c = value_str[i];
-
-      if( c==',') continue;
-
-      if(c == '[') {
-         // found an array, find the corresponding ']' from the right side
-         size_t i2 = value_str.find_last_of(']');
-
-         // strip the [] pair from both sides
-         // so we end up with a string of comma separated values (which may be vectors)
-         return parse_vector(value_str.substr(i+1,i2-1),line_no);
-      }
-      else {
-         // found a scalar
-         return std::make_shared<csg_scalar>(value_str,line_no);
-      }
+   size_t i = value_str.find_first_not_of(" \t\r\n,");
+   if(i == std::string_view::npos) return std::shared_ptr<csg_value>();
+
+   if(value_str[i] == '[') {
+      // numeric vectors are parsed directly into a flat buffer,
+      // anything else is handled by the general vector parser
+      std::shared_ptr<csg_value> array = csg_array::parse(value_str.substr(i),line_no);
+      if(array.get()) return array;
+      return parse_vector(value_str.substr(i),line_no);
    }
 
-   return value;
+   // found a scalar
+   return std::make_shared<csg_scalar>(std::string(value_str),line_no);
 }
 
-std::shared_ptr<csg_value> csg_value::parse_vector(const std::string& values, size_t line_no)
+static std::string_view trim(std::string_view text)
 {
-   std::vector<std::shared_ptr<csg_value>> vec;
-   std::string token;
-
-   size_t icount = 0;
-   for(size_t i=0; i<values.size(); i++) {
-      char c = values[i];
-
-      if(c == '[') icount++;
-      if(c == ']') icount--;
-      token +=c;
+   size_t first = text.find_first_not_of(" \t\r\n");
+   if(first == std::string_view::npos) return std::string_view();
+   size_t last = text.find_last_not_of(" \t\r\n");
+   return text.substr(first,last-first+1);
+}
 
-      if(icount==0 && c == ']') {
-         // end of vector data
-         size_t len = token.size();
-         std::string vals = token.substr(1,len-2);
-         vec.push_back(parse_vector(vals,line_no));
-         token  = "";
-         icount = 0;
+std::shared_ptr<csg_value> csg_value::parse_vector(std::string_view values, size_t line_no)
+{
+   // single pass, the vectors not yet closed are kept on a stack
+   std::vector<std::vector<std::shared_ptr<csg_value>>> open;
 
-         // eat following comma
+   size_t i = 0;
+   while(i < values.size()) {
+      char c = values[i];
+      if(c == '[') {
+         open.emplace_back();
+         i++;
+      }
+      else if(c == ']') {
+         if(open.size() == 0) break;
+         auto vec = std::make_shared<csg_vector>(open.back(),line_no);
+         open.pop_back();
+         if(open.size() == 0) return vec;
+         open.back().push_back(vec);
          i++;
       }
-      else if(icount==0 && (c == ',' || i==values.size()-1) ) {
-         // end of scalar data
-         size_t len = (c == ',')? token.size()-1 : token.size();
-         std::string val = token.substr(0,len);
-         vec.push_back(std::make_shared<csg_scalar>(val,line_no));
-         token  = "";
-         icount = 0;
+      else if(c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+         i++;
+      }
+      else {
+         // scalar, ends at next comma or bracket outside quotes
+         size_t j = i;
+         bool quoted = false;
+         while(j < values.size() && (quoted || (values[j] != ',' && values[j] != '[' && values[j] != ']'))) {
+            if(values[j] == '"') quoted = !quoted;
+            j++;
+         }
+         if(open.size() == 0) break;
+         open.back().push_back(std::make_shared<csg_scalar>(std::string(trim(values.substr(i,j-i))),line_no));
+         i = j;
       }
    }
-   return std::make_shared<csg_vector>(vec,line_no);
-}
-
 
+   throw std::runtime_error(".csg file line " + std::to_string(line_no) +", csg_value::parse_vector(), unbalanced [] in value");
+}
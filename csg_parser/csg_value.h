@@ -17,7 +17,9 @@
 #define CSG_VALUE_H
 
 #include <string>
+#include <string_view>
 #include <memory>
+class csg_array;
 
 // abstract parameter value for csg node
 class csg_value {
@@ -25,12 +27,16 @@ public:
    csg_value(size_t line_no);
    virtual ~csg_value();
 
-   // convert a value string into a csg_value, possibly a scalar or (nested) vector
-   static std::shared_ptr<csg_value> parse(const std::string& value_str, size_t line_no);
-   static std::shared_ptr<csg_value> parse_vector(const std::string& value_str, size_t line_no);
+   // convert a value string into a csg_value, possibly a scalar or (nested) vector.
+   // Numeric vectors of rank 1 or 2 become a csg_array
+   static std::shared_ptr<csg_value> parse(std::string_view value_str, size_t line_no);
+   static std::shared_ptr<csg_value> parse_vector(std::string_view value_str, size_t line_no);
 
    virtual bool is_vector() const { return false; }
 
+   // returns this if the value is a csg_array, otherwise nullptr
+   virtual const csg_array* as_array() const { return nullptr; }
+
    // 1 for scalars, 1+ for vectors
    virtual size_t size() const = 0;
 
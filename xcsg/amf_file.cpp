@@ -14,9 +14,12 @@
 // EndLicense:
 
 #include "amf_file.h"
-#include "csg_parser/cf_xmlTree.h"
-#include <carve/poly.hpp>
+#include "lump_mesh.h"
+#include "text_buffer.h"
+#include "zip_streambuf.h"
 #include <ctime>
+#include <fstream>
+#include <stdexcept>
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/convenience.hpp>
@@ -31,15 +34,25 @@ amf_file::~amf_file()
    //dtor
 }
 
-std::string amf_file::write(std::shared_ptr<poly_vector> polyset, const std::string& file_path)
+// escape the XML special characters in text
+static std::string xml_escape(const std::string& text)
 {
-   // ISO8601 date and time string of current time
-   time_t now = time(0);
-   const size_t blen = 80;
-   char buffer[blen];
-   strftime(buffer,blen,"%Y-%m-%dT%H:%M:%S",gmtime(&now));
-   string iso8601(buffer);
+   std::string escaped;
+   for(char c : text) {
+      switch(c) {
+         case '&':  escaped += "&amp;";  break;
+         case '<':  escaped += "&lt;";   break;
+         case '>':  escaped += "&gt;";   break;
+         case '"':  escaped += "&quot;"; break;
+         case '\'': escaped += "&apos;"; break;
+         default:   escaped += c;
+      }
+   }
+   return escaped;
+}
 
+std::string amf_file::write(std::shared_ptr<lump_vector> lumps, const std::string& file_path, bool compress)
+{
    boost::filesystem::path fullpath(file_path);
    boost::filesystem::path amf_path = fullpath.parent_path() / fullpath.stem();
    std::string path = amf_path.string() + ".amf";
@@ -47,66 +60,84 @@ std::string amf_file::write(std::shared_ptr<poly_vector> polyset, const std::str
    // fix inconsistent slashes to something that is consistent and works everytwhere
    std::replace(path.begin(),path.end(), '\\', '/');
 
-   cf_xmlTree tree;
-   if(tree.create_root("amf")) {
-      cf_xmlNode root;
-      if(tree.get_root(root)) {
-         root.add_property("unit","millimeter");
-
-         // add some metadata
-         cf_xmlNode name      = root.add_child("metadata"); name.add_property("type","name");         name.put_value(fullpath.stem().string());
-         cf_xmlNode date_time = root.add_child("metadata"); date_time.add_property("type","created"); date_time.put_value(iso8601);
-         cf_xmlNode software  = root.add_child("metadata"); software.add_property("type","software"); software.put_value("xcsg");
-
-         // write one amf "object" per polyhedron
-         for(size_t ipoly=0; ipoly<polyset->size(); ipoly++) {
-            to_amf_object(root,polyset,ipoly);
-         }
-
-         tree.write_xml(path);
-      }
+   std::string name = fullpath.stem().string();
+   if(compress) {
+      // the zip archive contains a single deflate compressed .amf entry
+      zip_streambuf zip(path,name + ".amf");
+      std::ostream out(&zip);
+      write_document(out,lumps,name);
+      zip.close();
+   }
+   else {
+      std::ofstream out(path,std::ios::binary);
+      if(!out.is_open()) throw std::logic_error("amf_file::write(...)  Failed to open: " + path);
+      write_document(out,lumps,name);
    }
 
    return path;
 }
 
-
-bool amf_file::to_amf_object(cf_xmlNode& parent, std::shared_ptr<poly_vector> polyset, size_t index)
+void amf_file::write_document(std::ostream& out, std::shared_ptr<lump_vector> lumps, const std::string& name)
 {
-   std::shared_ptr<carve::poly::Polyhedron> poly = (*polyset)[index];
+   // ISO8601 date and time string of current time
+   time_t now = time(0);
+   const size_t blen = 80;
+   char buffer[blen];
+   strftime(buffer,blen,"%Y-%m-%dT%H:%M:%S",gmtime(&now));
+   std::string iso8601(buffer);
 
-   cf_xmlNode object = parent.add_child("object");
-   object.add_property("id",index);
-   cf_xmlNode mesh = object.add_child("mesh");
+   out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+   out << "<amf unit=\"millimeter\">\n";
 
-   cf_xmlNode vertices = mesh.add_child("vertices");
-   for(size_t ivert=0; ivert<poly->vertices.size(); ivert++) {
-      carve::poly::Geometry<3>::vertex_t& vtx = poly->vertices[ivert];
+   // add some metadata
+   out << "\t<metadata type=\"name\">"     << xml_escape(name) << "</metadata>\n";
+   out << "\t<metadata type=\"created\">"  << iso8601          << "</metadata>\n";
+   out << "\t<metadata type=\"software\">" << "xcsg"           << "</metadata>\n";
 
-      cf_xmlNode coordinates = vertices.add_child("vertex").add_child("coordinates");
-      coordinates.add_child("x").put_value(vtx.v[0]);
-      coordinates.add_child("y").put_value(vtx.v[1]);
-      coordinates.add_child("z").put_value(vtx.v[2]);
+   // write one amf "object" per lump
+   for(size_t ilump=0; ilump<lumps->size(); ilump++) {
+      write_object(out,*(*lumps)[ilump],ilump);
    }
 
-   cf_xmlNode volume = mesh.add_child("volume");
-
-   const string vtags[] = { "v1", "v2", "v3" } ;
-
-   for(size_t iface = 0; iface<poly->faces.size(); ++iface) {
-      carve::poly::Face<3>& face = poly->faces[iface];
-
-      size_t nvert = face.nVertices();
-      if(nvert != 3)throw std::logic_error("amf_file::to_xml, non-triangular face encountered!");
+   out << "</amf>\n";
+}
 
-      cf_xmlNode triangle = volume.add_child("triangle");
-      std::vector<const carve::poly::Polyhedron::vertex_t *> vloop;
-      poly->faces[iface].getVertexLoop(vloop);
-      for(size_t ivert=0; ivert<nvert; ivert++) {
-         size_t index = poly->vertexToIndex(vloop[ivert]);
-         triangle.add_child(vtags[ivert]).put_value(index);
+void amf_file::write_object(std::ostream& out, const lump_mesh& lump, size_t index)
+{
+   // vertices and triangles are formatted in blocks of this size
+   const size_t block_size = 8192;
+
+   out << "\t<object id=\"" << index << "\">\n";
+   out << "\t\t<mesh>\n";
+
+   out << "\t\t\t<vertices>\n";
+   text_buffer::write_blocks(out,lump.v_size(),block_size,[&lump](size_t v_begin, size_t v_end, text_buffer& buf) {
+      for(size_t ivert=v_begin; ivert<v_end; ivert++) {
+         const xvertex& vtx = lump.v_get(ivert);
+         buf.put("\t\t\t\t<vertex>\n\t\t\t\t\t<coordinates>\n");
+         buf.put("\t\t\t\t\t\t<x>").put(vtx.x).put("</x>\n");
+         buf.put("\t\t\t\t\t\t<y>").put(vtx.y).put("</y>\n");
+         buf.put("\t\t\t\t\t\t<z>").put(vtx.z).put("</z>\n");
+         buf.put("\t\t\t\t\t</coordinates>\n\t\t\t\t</vertex>\n");
       }
-   }
+   });
+   out << "\t\t\t</vertices>\n";
+
+   out << "\t\t\t<volume>\n";
+   text_buffer::write_blocks(out,lump.f_size(),block_size,[&lump](size_t f_begin, size_t f_end, text_buffer& buf) {
+      for(size_t iface=f_begin; iface<f_end; iface++) {
+         lump_mesh::face_ref face = lump.f_get(iface);
+         if(face.size() != 3)throw std::logic_error("amf_file::write_object, non-triangular face encountered!");
+
+         buf.put("\t\t\t\t<triangle>\n");
+         buf.put("\t\t\t\t\t<v1>").put(uint64_t(face[0])).put("</v1>\n");
+         buf.put("\t\t\t\t\t<v2>").put(uint64_t(face[1])).put("</v2>\n");
+         buf.put("\t\t\t\t\t<v3>").put(uint64_t(face[2])).put("</v3>\n");
+         buf.put("\t\t\t\t</triangle>\n");
+      }
+   });
+   out << "\t\t\t</volume>\n";
 
-   return true;
+   out << "\t\t</mesh>\n";
+   out << "\t</object>\n";
 }
@@ -16,26 +16,28 @@
 #ifndef AMF_FILE_H
 #define AMF_FILE_H
 
-class cf_xmlNode;
 #include <vector>
 #include <memory>
-#include <carve/csg.hpp>
 #include <ostream>
+#include <string>
+class lump_mesh;
 
 class amf_file {
 public:
-   typedef std::vector<std::shared_ptr<carve::poly::Polyhedron>> poly_vector;
+   typedef std::vector<std::shared_ptr<lump_mesh>> lump_vector;
 
    amf_file();
    virtual ~amf_file();
 
    // export to AMF, return the path to the file created
    // input is full path to file, file extension will be replaced to ".amf"
-   std::string  write(std::shared_ptr<poly_vector> polyset, const std::string& file_path);
+   // the lumps must be triangulated. The XML is streamed directly to the file,
+   // with compress=true the .amf file is a zip archive as allowed by the AMF standard
+   std::string  write(std::shared_ptr<lump_vector> lumps, const std::string& file_path, bool compress = false);
 
 protected:
-   bool to_amf_object(cf_xmlNode& parent, std::shared_ptr<poly_vector> polyset, size_t index);
-
+   void write_document(std::ostream& out, std::shared_ptr<lump_vector> lumps, const std::string& name);
+   void write_object(std::ostream& out, const lump_mesh& lump, size_t index);
 };
 
 #endif // AMF_FILE_H
@@ -16,6 +16,7 @@
 #include "boolean_timer.h"
 #include <iostream>
 #include <iomanip>
+#include "xcsg_status.h"
 
 boolean_timer::boolean_timer()
 {}
@@ -29,6 +30,8 @@ void boolean_timer::init(int nbool)
    m_nbool_tot = (nbool>0)? nbool : 1;
    m_progress = 0;
    m_progress_report = 0;
+   m_status_report = 0;
+   m_time_init = std::chrono::steady_clock::now();
 }
 
 void boolean_timer::add_nbool(int nbool)
@@ -51,6 +54,13 @@ void boolean_timer::add_elapsed(double esec)
       double percent = m_progress*0.1;
       std::cout << std::setprecision(3) << "...boolean progress: " << percent <<"% " << std::endl;
    }
+
+   // the status stream is reported at every 1% progress
+   if(xcsg_status::singleton().is_open() && (m_progress - m_status_report) >= 10) {
+      unsigned int p = m_progress;
+      m_status_report = p;
+      xcsg_status::singleton().progress(m_nbool,m_nbool_tot,wall_elapsed(),eta());
+   }
 }
 
 
@@ -58,3 +68,20 @@ double boolean_timer::thread_elapsed()
 {
    return m_elapsed_millisec*0.001;
 }
+
+double boolean_timer::wall_elapsed()
+{
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_time_init).count();
+}
+
+double boolean_timer::eta()
+{
+   unsigned int nbool     = m_nbool;
+   unsigned int nbool_tot = m_nbool_tot;
+   if(nbool == 0) return -1.0;
+   if(nbool >= nbool_tot) return 0.0;
+
+   // booleans run in parallel threads, so the wall clock rate is the relevant one
+   double rate = nbool/wall_elapsed();
+   return (nbool_tot-nbool)/rate;
+}
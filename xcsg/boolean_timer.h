@@ -17,6 +17,7 @@
 #define BOOLEAN_TIMER_H
 
 #include <atomic>
+#include <chrono>
 
 class boolean_timer {
 public:
@@ -35,6 +36,12 @@ public:
    // return total elapsed in threads so far
    double thread_elapsed();
 
+   // return wall clock seconds since init
+   double wall_elapsed();
+
+   // estimated remaining wall clock seconds, based on the boolean rate so far. Returns -1 if unknown
+   double eta();
+
 protected:
    boolean_timer();
    virtual ~boolean_timer();
@@ -49,6 +56,9 @@ private:
    std::atomic_uint  m_nbool;               // number of booleans processed so far
    std::atomic_uint  m_progress;            // A value from [0..1000] measuring progress, i.e. per thousand
    std::atomic_uint  m_progress_report;     // progress value for previous report
+   std::atomic_uint  m_status_report;       // progress value for previous status stream report
+
+   std::chrono::steady_clock::time_point m_time_init;  // wall clock time at init
 };
 
 #endif // BOOLEAN_TIMER_H
@@ -46,11 +46,20 @@ boost_command_line::boost_command_line(int argc , char **argv)
 , m_max_bool(std::numeric_limits<size_t>::max())
 , m_export_dir(false,"")
 , m_secant_tolerance(0.05)
+, m_status_fd(-1)
+, m_quiet(false)
+, m_timeout(0.0)
+, m_partial(false)
+, m_perf(false)
+, m_out_count(0)
+, m_stdin(false)
+, m_stdout(false)
 {
    generic.add_options()
         ("help,h",  "Show this help message.")
         ("version,v",  "Show program version (numeric part).")
         ("amf",   "AMF output format (Additive Manufacturing Format)")
+        ("amf_zip", "AMF output format, zip compressed")
         ("csg",   "CSG output format (OpenSCAD)")
         ("dxf",   "DXF output format (AutoCAD DXF - 2D only)")
         ("svg",   "SVG output format (Scalar Vector Graphics - 2D only)")
@@ -58,14 +67,27 @@ boost_command_line::boost_command_line(int argc , char **argv)
         ("astl",  "STL output format (STereoLitography) - ASCII")
         ("obj",   "OBJ output format (Wavefront format)")
         ("off",   "OFF output format (Geomview Object File Format)")
+        ("ply",   "PLY output format (Polygon File Format) - binary")
+        ("xcsg",  "XCSG output format, converted from .csg, .xcsgb or .xcsg.json input")
+        ("xcsgb", "XCSGB output format (binary, memory mappable xcsg)")
+        ("no_xcsg", "Do not write the .xcsg file converted from .csg input")
+        ("compact_xcsg", "Write .xcsg output with compact text encoded vertices and faces")
         ("export_dir", po::value<std::string>(), "Export output files to directory")
         ("max_bool", po::value<size_t>(),  "Max number of booleans allowed")
         ("sec_tol", po::value<double>(),  "Secant tolerance when importing OpenSCAD csg (0.05)")
         ("fullpath", "Show full file paths.")
+        ("status_fd", po::value<int>(), "Write JSON status lines to file descriptor")
+        ("json_progress", "Write JSON status lines to stdout (implies --quiet)")
+        ("quiet", "Suppress human readable console output")
+        ("timeout", po::value<double>(), "Abort processing after given number of seconds")
+        ("partial", "Write partial results to <name>_partial.stl when aborted")
+        ("perf", "Report hardware performance counters per phase (Linux)")
+        ("stats", "Report mesh quality statistics per lump and faces per primitive type")
          ;
 
    hidden.add_options()
-        ("xcsg-file",   po::value<string>(),         "input file") ;
+        ("xcsg-file",   po::value<string>(),         "input file")
+        ("output-file", po::value<string>(),         "output file") ;
 
    allowed.add(generic).add(hidden);
 
@@ -73,6 +95,7 @@ boost_command_line::boost_command_line(int argc , char **argv)
    // declare that we require exactly 1 such parameter (-1 would mean unlimited number)
    po::positional_options_description p;
    p.add("xcsg-file", 1);
+   p.add("output-file", 1);
 
    // Parse the command line catching and displaying any
    // parser errors
@@ -106,11 +129,15 @@ boost_command_line::boost_command_line(int argc , char **argv)
       // no message here, it is handled below
       error_count++;
    }
+   else if(get<std::string>("xcsg-file") == "-") {
+      m_stdin = true;
+   }
    else {
       boost::filesystem::path fullpath(get<std::string>("xcsg-file"));
-      if(fullpath.extension() != ".xcsg" && fullpath.extension() != ".csg") {
+      bool json = (fullpath.extension() == ".json" && fullpath.stem().extension() == ".xcsg");
+      if(fullpath.extension() != ".xcsg" && fullpath.extension() != ".xcsgb" && fullpath.extension() != ".csg" && !json) {
          ostringstream sout;
-         sout << "ERROR: Input file extension must be '.xcsg', file name was " << fullpath;
+         sout << "ERROR: Input file extension must be '.xcsg', '.xcsgb', '.xcsg.json' or '.csg', file name was " << fullpath;
          error_list.push_back(sout.str());
          error_count++;
       }
@@ -129,7 +156,9 @@ boost_command_line::boost_command_line(int argc , char **argv)
    }
 
    // check the output format specifiers
-   size_t out_count = vm.count("amf") + vm.count("csg") + vm.count("stl") + vm.count("astl") + vm.count("obj") + vm.count("off") + vm.count("dxf") + vm.count("svg");
+   size_t out_count = vm.count("amf") + vm.count("amf_zip") + vm.count("csg") + vm.count("stl") + vm.count("astl") + vm.count("obj") + vm.count("off") + vm.count("ply") + vm.count("dxf") + vm.count("svg")
+                    + vm.count("xcsg") + vm.count("xcsgb");
+   m_out_count = out_count;
    if(out_count == 0  && vm.count("xcsg-file")>0) {
 
       // input file name specified, but no output format(s)
@@ -145,6 +174,27 @@ boost_command_line::boost_command_line(int argc , char **argv)
       error_count++;
    }
 
+   // the only explicit output is standard output, file names are derived from the input file
+   if(vm.count("output-file") > 0) {
+      if(get<std::string>("output-file") == "-") {
+         m_stdout = true;
+         if(out_count != 1 || (vm.count("stl") + vm.count("ply")) != 1) {
+            error_list.push_back("ERROR: Output to standard output requires exactly one of --stl or --ply");
+            error_count++;
+         }
+      }
+      else {
+         ostringstream sout;
+         sout << "ERROR: Output file must be '-' (standard output), was " << get<std::string>("output-file");
+         error_list.push_back(sout.str());
+         error_count++;
+      }
+   }
+   if(m_stdin && !m_stdout) {
+      error_list.push_back("ERROR: Input from standard input requires output to standard output, use '-' after the output format");
+      error_count++;
+   }
+
    if(vm.count("max_bool") > 0) {
       m_max_bool = get<size_t>("max_bool");
    }
@@ -153,6 +203,55 @@ boost_command_line::boost_command_line(int argc , char **argv)
       m_secant_tolerance = get<double>("sec_tol");
    }
 
+   if(vm.count("status_fd") > 0) {
+      m_status_fd = get<int>("status_fd");
+      if(m_status_fd < 1) {
+         ostringstream sout;
+         sout << "ERROR: 'status_fd' must be a valid file descriptor, got " << m_status_fd;
+         error_list.push_back(sout.str());
+         error_count++;
+      }
+      else if(m_status_fd == 1 && m_stdout) {
+         error_list.push_back("ERROR: 'status_fd' 1 and output to standard output cannot be combined");
+         error_count++;
+      }
+   }
+
+   if(vm.count("json_progress") > 0) {
+      if(vm.count("status_fd") > 0) {
+         error_list.push_back("ERROR: 'json_progress' and 'status_fd' cannot be combined");
+         error_count++;
+      }
+      if(m_stdout) {
+         error_list.push_back("ERROR: 'json_progress' and output to standard output cannot be combined");
+         error_count++;
+      }
+      m_status_fd = 1;
+      m_quiet     = true;
+   }
+
+   if(vm.count("quiet") > 0) {
+      m_quiet = true;
+   }
+
+   if(vm.count("timeout") > 0) {
+      m_timeout = get<double>("timeout");
+      if(m_timeout <= 0.0) {
+         ostringstream sout;
+         sout << "ERROR: 'timeout' must be a positive number of seconds, got " << m_timeout;
+         error_list.push_back(sout.str());
+         error_count++;
+      }
+   }
+
+   if(vm.count("partial") > 0) {
+      m_partial = true;
+   }
+
+   if(vm.count("perf") > 0) {
+      m_perf = true;
+   }
+
    // some things are counted as errors without error message
    // this causes m_parse_ok to be false and the program stops
    if(out_count == 0)  error_count++;
@@ -183,7 +282,8 @@ void boost_command_line::show_version()
 void boost_command_line::show_help()
 {
    if(!m_help_shown) {
-      cout << generic << "  <xcsg-file>\t\tpath to input .xcsg file (required)" << endl << endl;
+      cout << generic << "  <xcsg-file>\t\tpath to input .xcsg, .xcsgb, .xcsg.json or .csg file, - for standard input (required)" << endl
+                      << "  -\t\t\twrite the --stl or --ply output to standard output" << endl << endl;
       m_help_shown = true;
    }
 }
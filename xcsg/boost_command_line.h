@@ -42,6 +42,31 @@ public:
 
    std::pair<bool,std::string> export_dir() { return m_export_dir; }
 
+   // file descriptor for machine readable status stream, -1 if none
+   int status_fd() const { return m_status_fd; }
+
+   // true if human readable console output shall be suppressed
+   bool quiet() const { return m_quiet; }
+
+   // wall clock timeout in seconds, 0 means no timeout
+   double timeout() const { return m_timeout; }
+
+   // true if partial results shall be written when processing is aborted
+   bool partial() const { return m_partial; }
+
+   // true if hardware performance counters shall be reported
+   bool perf() const { return m_perf; }
+
+   // number of output formats requested
+   size_t out_count() const { return m_out_count; }
+
+   // true if the input is read from standard input ("-" as input file)
+   bool stdin_input() const { return m_stdin; }
+
+   // true if the single output format is written to standard output ("-" after the input file).
+   // Human readable output is then written to standard error
+   bool stdout_output() const { return m_stdout; }
+
 private:
    boost::program_options::options_description generic;
    boost::program_options::options_description hidden;
@@ -53,6 +78,14 @@ private:
    size_t m_max_bool;
    double m_secant_tolerance;
    std::pair<bool,std::string> m_export_dir;
+   int    m_status_fd;
+   bool   m_quiet;
+   double m_timeout;
+   bool   m_partial;
+   bool   m_perf;
+   size_t m_out_count;
+   bool   m_stdin;
+   bool   m_stdout;
 };
 
 #endif // BOOST_COMMAND_LINE_H
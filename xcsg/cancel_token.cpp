@@ -0,0 +1,109 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "cancel_token.h"
+#include <csignal>
+#include <sstream>
+
+// set from the signal handler, only lock free atomic stores are allowed there
+static std::atomic_bool s_signalled(false);
+
+extern "C" void cancel_token_signal_handler(int)
+{
+   s_signalled = true;
+}
+
+cancel_token::cancel_token()
+: m_cancelled(false)
+, m_has_deadline(false)
+, m_keep_partial(false)
+, m_timeout(0.0)
+{}
+
+cancel_token::~cancel_token()
+{}
+
+void cancel_token::set_timeout(double sec)
+{
+   m_has_deadline = false;
+   if(sec > 0.0) {
+      m_timeout  = sec;
+      m_deadline = std::chrono::steady_clock::now()
+                 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(sec));
+      m_has_deadline = true;
+   }
+}
+
+void cancel_token::install_signal_handlers()
+{
+   std::signal(SIGINT,cancel_token_signal_handler);
+   std::signal(SIGTERM,cancel_token_signal_handler);
+}
+
+void cancel_token::cancel(const std::string& reason)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   if(m_reason.length() == 0) m_reason = reason;
+   m_cancelled = true;
+}
+
+bool cancel_token::cancelled()
+{
+   if(m_cancelled) return true;
+
+   if(s_signalled) {
+      cancel("interrupted by signal");
+   }
+   else if(m_has_deadline && std::chrono::steady_clock::now() > m_deadline) {
+      std::ostringstream out;
+      out << "timeout after " << m_timeout << " sec";
+      cancel(out.str());
+   }
+   return m_cancelled;
+}
+
+void cancel_token::check()
+{
+   if(cancelled()) throw cancel_exception(reason());
+}
+
+void cancel_token::check(safe_queue<MeshSet_ptr>& mesh_queue)
+{
+   if(!cancelled()) return;
+
+   // take what is left in the queue. When partial results are not kept,
+   // dropping the pointers here releases the memory
+   MeshSet_ptr mesh;
+   while(mesh_queue.try_dequeue(mesh)) {
+      if(m_keep_partial && mesh.get()) {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_partial.push_back(mesh);
+      }
+      mesh.reset();
+   }
+   throw cancel_exception(reason());
+}
+
+std::string cancel_token::reason()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   return m_reason;
+}
+
+std::vector<cancel_token::MeshSet_ptr> cancel_token::partial()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   return m_partial;
+}
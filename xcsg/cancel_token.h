@@ -0,0 +1,92 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef CANCEL_TOKEN_H
+#define CANCEL_TOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <carve/csg.hpp>
+#include "safe_queue.h"
+
+// cancel_exception is thrown when processing stops due to cancellation or timeout
+
+class cancel_exception : public std::runtime_error {
+public:
+   cancel_exception(const std::string& reason) : std::runtime_error(reason) {}
+};
+
+// cancel_token is a process wide cooperative cancellation flag.
+// Boolean, hull and mesh threads call cancelled() between operations and
+// stop picking new work when it returns true. The thread launching the work
+// calls check(queue) after joining, which optionally keeps the meshes completed
+// so far as partial results and throws cancel_exception.
+
+class cancel_token {
+public:
+   typedef std::shared_ptr<carve::mesh::MeshSet<3>> MeshSet_ptr;
+
+   static cancel_token& singleton()  { static cancel_token instance; return instance;  }
+
+   // set wall clock timeout in seconds, counting from now. Zero or negative means no timeout
+   void set_timeout(double sec);
+
+   // stop on SIGINT/SIGTERM the same way as on timeout
+   void install_signal_handlers();
+
+   // request cancellation, the first reason given is kept
+   void cancel(const std::string& reason);
+
+   // return true when cancellation is requested or the timeout has expired.
+   // This is cheap and may be called from any thread.
+   bool cancelled();
+
+   // throw cancel_exception if cancelled
+   void check();
+
+   // if cancelled: move queue contents to partial results (if kept) and throw cancel_exception
+   void check(safe_queue<MeshSet_ptr>& mesh_queue);
+
+   // the reason for cancellation
+   std::string reason();
+
+   // keep partial results for diagnosis when cancelled (default false, memory is released)
+   void set_keep_partial(bool keep) { m_keep_partial = keep; }
+
+   // return the partial results collected
+   std::vector<MeshSet_ptr> partial();
+
+protected:
+   cancel_token();
+   virtual ~cancel_token();
+
+private:
+   std::atomic_bool                      m_cancelled;
+   std::atomic_bool                      m_has_deadline;
+   std::atomic_bool                      m_keep_partial;
+   std::chrono::steady_clock::time_point m_deadline;
+   double                                m_timeout;
+
+   std::mutex                            m_mutex;     // protects m_reason and m_partial
+   std::string                           m_reason;
+   std::vector<MeshSet_ptr>              m_partial;
+};
+
+#endif // CANCEL_TOKEN_H
@@ -17,12 +17,15 @@
 
 #include "carve_boolean.h"
 #include "xpolyhedron.h"
+#include "lump_mesh.h"
 //#include <carve/mesh_simplify.hpp>
 #include "carve/mesh_simplify.hpp"
 #include <carve/input.hpp>
 
 #include "boolean_timer.h"
 #include "mesh_utils.h"
+#include "run_concurrently.h"
+#include "perf_counters.h"
 
 std::string carve_boolean::boolean_type(carve::csg::CSG::OP op)
 {
@@ -62,9 +65,18 @@ size_t carve_boolean::compute( std::shared_ptr<carve::mesh::MeshSet<3>> b,  carv
          // the time runs only when an actual boolean is taking place
          boost::posix_time::ptime p1 = boost::posix_time::microsec_clock::universal_time();
 
+         // optional hardware counters, summed over all booleans in all threads
+         perf_registry& perf = perf_registry::singleton();
+         perf_values perf0;
+         if(perf.enabled()) perf0 = perf_counters::thread_counters().read();
+
          carve::csg::CSG  csg;
          m_meshset = std::shared_ptr<carve::mesh::MeshSet<3>>(csg.compute(m_meshset.get(),b.get(),op));
 
+         if(perf.enabled() && perf_counters::thread_counters().available()) {
+            perf.add("carve_boolean",perf_counters::thread_counters().read() - perf0);
+         }
+
          boost::posix_time::time_duration  ptime_diff = boost::posix_time::microsec_clock::universal_time() - p1;
          double elapsed_sec = 0.001*ptime_diff.total_milliseconds();
 
@@ -86,58 +98,101 @@ size_t carve_boolean::size() const
    return  m_meshset->meshes.size();
 }
 
+// Traverse the faces of a manifold once, walking the edge loop of each face.
+// add_vertex is called for each vertex on first use, new vertices get local indices in
+// that order. add_face is called with the local vertex indices of each face.
+template <typename AddVertex, typename AddFace>
+static void traverse_manifold(const carve::mesh::MeshSet<3>& meshset, const carve::mesh::Mesh<3>* mesh, AddVertex add_vertex, AddFace add_face)
+{
+   typedef carve::mesh::Face<3>::vertex_t vertex_t;
+   typedef carve::mesh::Face<3>::edge_t   edge_t;
+
+   // Vertices are stored in the meshset vertex storage, so the position in the storage
+   // identifies a vertex. The stamp arrays map storage position to local vertex index.
+   // They are kept per thread and never cleared, instead a generation number tells
+   // whether an entry was set in this call.
+   thread_local std::vector<uint32_t> stamp;
+   thread_local std::vector<uint32_t> local_index;
+   thread_local uint32_t generation = 0;
+
+   const std::vector<vertex_t>& storage = meshset.vertex_storage;
+   const vertex_t* base  = (storage.size()>0)? &storage[0] : 0;
+   const size_t nstorage = storage.size();
+   if(stamp.size() < nstorage) {
+      stamp.resize(nstorage,0);
+      local_index.resize(nstorage,0);
+   }
+   if(++generation == 0) {
+      std::fill(stamp.begin(),stamp.end(),0);
+      generation = 1;
+   }
+
+   std::vector<uint32_t> indices;
+   uint32_t nvert = 0;
+   size_t nfaces = mesh->faces.size();
+   for (size_t iface=0; iface<nfaces; iface++) {
+      const carve::mesh::Face<3>* face = mesh->faces[iface];
+      size_t nv = face->n_edges;
+      indices.resize(nv);
+      const edge_t* edge = face->edge;
+      for(size_t i=0;i<nv;i++) {
+         const vertex_t* vertex = edge->vert;
+         size_t iv = static_cast<size_t>(vertex - base);
+         if(iv >= nstorage) throw std::logic_error("carve_boolean: vertex not in vertex storage");
+         if(stamp[iv] != generation) {
+            stamp[iv]       = generation;
+            local_index[iv] = nvert++;
+            add_vertex(vertex->v);
+         }
+         indices[i] = local_index[iv];
+         edge = edge->next;
+      }
+      add_face(indices);
+   }
+}
+
 std::shared_ptr<xpolyhedron> carve_boolean::create_manifold(size_t manifold_id) const
 {
    std::shared_ptr<xpolyhedron>  poly = 0;
 
    if(manifold_id<m_meshset->meshes.size()) {
-
       carve::mesh::Mesh<3>* mesh = m_meshset->meshes[manifold_id];
-      size_t nfaces = mesh->faces.size();
-
-      // find the vertices referenced by the selected manifold
-      std::map<carve::mesh::Face<3>::vertex_t*,size_t> vi_map;
-      std::map<size_t,carve::mesh::Face<3>::vertex_t*> iv_map;
-      for (size_t iface=0; iface<nfaces; iface++) {
-         carve::mesh::Face<3>* face = mesh->faces[iface];
-         std::vector<carve::mesh::Face<3>::vertex_t*> verts;
-         face->getVertices(verts);
-         for(size_t i=0;i<verts.size();i++) {
-            carve::mesh::Face<3>::vertex_t* vertex = verts[i];
-            if(vi_map.find(vertex) == vi_map.end()) {
-               size_t index = vi_map.size();
-               vi_map.insert(std::make_pair(vertex,index));
-               iv_map.insert(std::make_pair(index,vertex));
-            }
-         }
-      }
-
-      // create polyhedron referencing only the relevant vertices
       poly = std::shared_ptr<xpolyhedron>(new xpolyhedron());
-      poly->v_reserve(vi_map.size());
-      poly->f_reserve(nfaces);
-      for(auto i=iv_map.begin(); i!=iv_map.end();i++) {
-        carve::mesh::Face<3>::vertex_t* vtx = i->second;
-        poly->v_add(vtx->v);
-      }
-
-      // recompute face vertex indices
-      for (size_t iface=0; iface<nfaces; iface++) {
-         carve::mesh::Face<3>* face = mesh->faces[iface];
-         std::vector<carve::mesh::Face<3>::vertex_t*> verts;
-         face->getVertices(verts);
-         std::vector<size_t> indices;
-         indices.reserve(verts.size());
-         for(size_t i=0;i<verts.size();i++) {
-            carve::mesh::Face<3>::vertex_t* vertex = verts[i];
-            indices.push_back(vi_map[vertex]);
-         }
-         poly->f_add(xface(indices),false);
-      }
+      poly->f_reserve(mesh->faces.size());
+      traverse_manifold(*m_meshset,mesh,
+                        [&poly](const xvertex& pos)                 { poly->v_add(pos); },
+                        [&poly](const std::vector<uint32_t>& indices) { poly->f_add(xface(std::vector<size_t>(indices.begin(),indices.end()))); }
+                       );
    }
    return poly;
 }
 
+std::shared_ptr<lump_mesh> carve_boolean::create_lump(size_t manifold_id) const
+{
+   std::shared_ptr<lump_mesh>  lump = 0;
+
+   if(manifold_id<m_meshset->meshes.size()) {
+      carve::mesh::Mesh<3>* mesh = m_meshset->meshes[manifold_id];
+      size_t ncorners = 0;
+      for(auto face : mesh->faces) ncorners += face->n_edges;
+
+      lump = std::make_shared<lump_mesh>();
+      lump->reserve(ncorners/4,mesh->faces.size(),ncorners);
+      traverse_manifold(*m_meshset,mesh,
+                        [&lump](const xvertex& pos)                 { lump->v_add(pos); },
+                        [&lump](const std::vector<uint32_t>& indices) { lump->f_add(indices.data(),indices.size()); }
+                       );
+   }
+   return lump;
+}
+
+void carve_boolean::create_lumps(std::vector<std::shared_ptr<lump_mesh>>& lumps) const
+{
+   lumps.clear();
+   lumps.resize(size());
+   run_concurrently(lumps.size(),[this,&lumps](size_t imani) { lumps[imani] = create_lump(imani); });
+}
+
 std::shared_ptr<carve::mesh::MeshSet<3>> carve_boolean::mesh_set()
 {
    return m_meshset;
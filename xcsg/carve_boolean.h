@@ -19,6 +19,7 @@
 #include <vector>
 #include <memory>
 class xpolyhedron;
+class lump_mesh;
 #include <carve/csg.hpp>
 #include "qhull/qhull3d.h"
 
@@ -61,6 +62,10 @@ public:
    // create result manifolds from mesh
    std::shared_ptr<xpolyhedron>  create_manifold(size_t imani) const;
 
+   // create lean export meshes of all result manifolds directly from the mesh, concurrently
+   std::shared_ptr<lump_mesh>    create_lump(size_t imani) const;
+   void create_lumps(std::vector<std::shared_ptr<lump_mesh>>& lumps) const;
+
    // return the current mesh
    std::shared_ptr<carve::mesh::MeshSet<3>> mesh_set();
 
@@ -16,6 +16,7 @@
 
 #include "carve_boolean_thread.h"
 #include "carve_boolean.h"
+#include "cancel_token.h"
 #include <iostream>
 
 carve_boolean_thread::carve_boolean_thread(safe_queue<MeshSet_ptr>& mesh_queue, carve::csg::CSG::OP op, safe_queue<std::string>& exception_queue)
@@ -31,9 +32,11 @@ carve_boolean_thread::~carve_boolean_thread()
 void carve_boolean_thread::run()
 {
    // pick work from mesh queue as long as there are at least 2 meshes
+   // and processing has not been cancelled
 
+   cancel_token& cancel = cancel_token::singleton();
    try {
-      while(m_mesh_queue.size() > 1) {
+      while(m_mesh_queue.size() > 1 && !cancel.cancelled()) {
 
          MeshSet_ptr a,b;
          if(m_mesh_queue.try_dequeue(a)) {
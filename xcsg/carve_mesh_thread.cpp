@@ -1,6 +1,9 @@
 #include "carve_mesh_thread.h"
 #include <list>
 #include "boolean_timer.h"
+#include "cancel_token.h"
+#include "mesh_stats.h"
+#include <boost/core/demangle.hpp>
 #include <typeinfo>
 #include <stdexcept>
 
@@ -19,8 +22,11 @@ carve_mesh_thread::~carve_mesh_thread()
 
 void carve_mesh_thread::run()
 {
+   cancel_token& cancel = cancel_token::singleton();
    try {
       for(auto& solid : m_solids) {
+         if(cancel.cancelled()) break;
+
          std::shared_ptr<carve::mesh::MeshSet<3>> mesh = solid->create_carve_mesh(m_t);
 
          size_t nv = mesh->vertex_storage.size();
@@ -29,6 +35,7 @@ void carve_mesh_thread::run()
             throw std::runtime_error("ERROR: Solid of type '" + type + "' created empty mesh");
          }
 
+         record_source(*solid,mesh);
          m_mesh_queue.enqueue(mesh);
       }
    }
@@ -42,6 +49,16 @@ void carve_mesh_thread::run()
    }
 }
 
+void carve_mesh_thread::record_source(xsolid& solid, const MeshSet_ptr& mesh)
+{
+   mesh_source_stats& sources = mesh_source_stats::singleton();
+   if(sources.enabled() && solid.nbool()==0) {
+      size_t nface = 0;
+      for(auto m : mesh->meshes) nface += m->faces.size();
+      sources.add(boost::core::demangle(typeid(solid).name()),nface);
+   }
+}
+
 void carve_mesh_thread::create_mesh_queue(const carve::math::Matrix& t, std::unordered_set<std::shared_ptr<xsolid>> objects, safe_queue<MeshSet_ptr>& mesh_queue)
 {
    safe_queue<std::string> exception_queue;
@@ -70,6 +87,9 @@ void carve_mesh_thread::create_mesh_queue(const carve::math::Matrix& t, std::uno
          ithread->join();
       }
 
+      // when cancelled, exceptions from the threads are just consequences of it
+      cancel_token::singleton().check(mesh_queue);
+
       if(exception_queue.size() > 0) {
          throw std::logic_error(exception_queue.dequeue());
       }
@@ -33,6 +33,9 @@ public:
                                  std::list<std::shared_ptr<xsolid>> objects,
                                  safe_queue<MeshSet_ptr>& mesh_queue);
 
+   // record the mesh of a primitive solid (nbool()==0) in mesh_source_stats, if enabled
+   static void record_source(xsolid& solid, const MeshSet_ptr& mesh);
+
 protected:
    void run();
 
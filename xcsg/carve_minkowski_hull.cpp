@@ -3,6 +3,7 @@
 #include "carve_boolean.h"
 #include <carve/matrix.hpp>
 #include "xshape.h"
+#include "cancel_token.h"
 
 carve_minkowski_hull::carve_minkowski_hull(safe_queue<hull_pair>&  hull_queue,
                                           safe_queue<MeshSet_ptr>& mesh_queue,
@@ -19,8 +20,10 @@ carve_minkowski_hull::~carve_minkowski_hull()
 void carve_minkowski_hull::run()
 {
    // compute hull meshes as long as the hull queue is non-empty
+   // and processing has not been cancelled
+   cancel_token& cancel = cancel_token::singleton();
    try {
-      while(m_hull_queue.size() > 0) {
+      while(m_hull_queue.size() > 0 && !cancel.cancelled()) {
          hull_pair hp;
          if(m_hull_queue.try_dequeue(hp)) {
             m_mesh_queue.enqueue(compute_hull(hp));
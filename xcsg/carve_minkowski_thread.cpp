@@ -3,7 +3,9 @@
 #include "carve_boolean.h"
 #include "carve_triangulate.h"
 #include "carve_boolean_thread.h"
+#include "carve_mesh_thread.h"
 #include "xpolyhedron.h"
+#include "cancel_token.h"
 
 #include <map>
 
@@ -51,6 +53,8 @@ void carve_minkowski_thread::create_mesh_queue(const carve::math::Matrix& t,
    auto i = objects.begin();
    MeshSet_ptr meshA = (*i++)->create_carve_mesh(t);
    MeshSet_ptr meshB = (*i++)->create_carve_mesh(t);
+   carve_mesh_thread::record_source(*objects.front(),meshA);
+   carve_mesh_thread::record_source(*objects.back(),meshB);
 
    // meshA goes straight into the mesh queue as it will be unioned
    // with the hull meshes
@@ -82,6 +86,13 @@ void carve_minkowski_thread::create_mesh_queue(const carve::math::Matrix& t,
       ithread->join();
    }
 
+   // remaining hull pairs hold references to meshB, release them if cancelled
+   if(cancel_token::singleton().cancelled()) {
+      hull_pair hp;
+      while(hull_queue.try_dequeue(hp)) {}
+   }
+   cancel_token::singleton().check(mesh_queue);
+
    if(exception_queue.size() > 0) {
       throw std::logic_error(exception_queue.dequeue());
    }
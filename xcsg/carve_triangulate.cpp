@@ -18,6 +18,8 @@
 #include <carve/csg_triangulator.hpp>
 
 #include "carve_triangulate_face.h"
+#include "run_concurrently.h"
+#include "convex_polygon.h"
 #include <forward_list>
 
 // #include <boost/filesystem.hpp>
@@ -71,48 +73,94 @@ size_t carve_triangulate::compute(std::shared_ptr<carve::poly::Polyhedron> poly,
    // copy all vertices from onput polyhedron
    std::vector<carve::poly::Vertex<3> > out_vertices = poly->vertices;
 
-   // storage for triangulated vertices
-   std::vector<carve::poly::Face<3> > out_faces;
-
-   // compute number of output faces
-   size_t N = 0;
-   for (size_t i = 0; i < poly->faces.size(); ++i) {
-      carve::poly::Face<3> &f = poly->faces[i];
-      N += f.nVertices() - 2;
-   }
-   out_faces.reserve(N);
+   // faces are triangulated in contiguous chunks on the thread pool, each chunk with
+   // its own output buffer. The buffers are concatenated in chunk order, so the
+   // result is the same as for serial triangulation
+   const size_t chunk_size = 1024;
+   size_t nface  = poly->faces.size();
+   size_t nchunk = (nface + chunk_size - 1)/chunk_size;
+   std::vector<std::vector<carve::poly::Face<3>>> chunk_faces(nchunk);
+   std::vector<size_t> chunk_dropped(nchunk,0);
+
+   run_concurrently(nchunk,[&poly,&out_vertices,&chunk_faces,&chunk_dropped,chunk_size,nface,improve,degen_check](size_t ichunk) {
+
+      size_t f_begin = ichunk*chunk_size;
+      size_t f_end   = std::min(nface,f_begin+chunk_size);
+      std::vector<carve::poly::Face<3> >& out_faces = chunk_faces[ichunk];
+
+      // compute number of output faces
+      size_t N = 0;
+      for (size_t i = f_begin; i < f_end; ++i) {
+         carve::poly::Face<3> &f = poly->faces[i];
+         N += f.nVertices() - 2;
+      }
+      out_faces.reserve(N);
 
-   // triangulate each face
-   size_t nzero_dropped = 0;
-   for(size_t i = 0; i < poly->faces.size(); ++i) {
-      carve::poly::Face<3> &f = poly->faces[i];
+      // triangulate each face
       std::vector<carve::triangulate::tri_idx> result;
-
       std::vector<const carve::poly::Polyhedron::vertex_t *> vloop;
-      f.getVertexLoop(vloop);
+      std::vector<carve::geom2d::P2> proj;
+      for(size_t i = f_begin; i < f_end; ++i) {
+         carve::poly::Face<3> &f = poly->faces[i];
+         result.clear();
+         vloop.clear();
+         f.getVertexLoop(vloop);
 
-      carve::triangulate::triangulate(carve::poly::p2_adapt_project<3>(f.project), vloop, result);
-      if(improve && vloop.size()>3) {
-         carve::triangulate::improve(carve::poly::p2_adapt_project<3>(f.project), vloop, result);
-      }
+         // triangles and convex faces are handled directly,
+         // only concave faces need the general triangulator
+         bool convex = false;
+         if(vloop.size() == 3) {
+            result.push_back(carve::triangulate::tri_idx(0,1,2));
+            convex = true;
+         }
+         else if(vloop.size() > 3) {
+            proj.resize(vloop.size());
+            for(size_t iv=0; iv<vloop.size(); iv++) proj[iv] = f.project(vloop[iv]->v);
+            if(convex_polygon::is_convex(proj)) {
+               convex_polygon::triangulate(proj,result);
+               convex = true;
+            }
+         }
+
+         if(!convex) {
+            carve::triangulate::triangulate(carve::poly::p2_adapt_project<3>(f.project), vloop, result);
+            if(improve && vloop.size()>3) {
+               carve::triangulate::improve(carve::poly::p2_adapt_project<3>(f.project), vloop, result);
+            }
+         }
 
-      // add triangle faces to output
-      for (size_t j = 0; j < result.size(); ++j) {
-
-         // check the area of the triangulated face, ignore if degenerate
-        double face_area = (degen_check)? polyhedron_face_area( vloop[result[j].a], vloop[result[j].b], vloop[result[j].c] ) : 1.0;
-
-        if(0 <  face_area ) {
-            out_faces.push_back(carve::poly::Face<3>(
-               &out_vertices[poly->vertexToIndex_fast(vloop[result[j].a])],
-               &out_vertices[poly->vertexToIndex_fast(vloop[result[j].b])],
-               &out_vertices[poly->vertexToIndex_fast(vloop[result[j].c])]
-            ));
-        }
-        else {
-           nzero_dropped++;
-        }
+         // add triangle faces to output
+         for (size_t j = 0; j < result.size(); ++j) {
+
+            // check the area of the triangulated face, ignore if degenerate
+           double face_area = (degen_check)? polyhedron_face_area( vloop[result[j].a], vloop[result[j].b], vloop[result[j].c] ) : 1.0;
+
+           if(0 <  face_area ) {
+               out_faces.push_back(carve::poly::Face<3>(
+                  &out_vertices[poly->vertexToIndex_fast(vloop[result[j].a])],
+                  &out_vertices[poly->vertexToIndex_fast(vloop[result[j].b])],
+                  &out_vertices[poly->vertexToIndex_fast(vloop[result[j].c])]
+               ));
+           }
+           else {
+              chunk_dropped[ichunk]++;
+           }
+         }
       }
+   });
+
+   // storage for triangulated faces, chunks concatenated in order
+   size_t N = 0;
+   size_t nzero_dropped = 0;
+   for(size_t ichunk=0; ichunk<nchunk; ichunk++) {
+      N += chunk_faces[ichunk].size();
+      nzero_dropped += chunk_dropped[ichunk];
+   }
+   std::vector<carve::poly::Face<3> > out_faces;
+   out_faces.reserve(N);
+   for(auto& faces : chunk_faces) {
+      out_faces.insert(out_faces.end(),faces.begin(),faces.end());
+      std::vector<carve::poly::Face<3>>().swap(faces);
    }
    if(nzero_dropped>0) std::cout << ">>> Warning: dropped "<<nzero_dropped <<" zero area triangles(s) during triangulation." << std::endl;
 
@@ -0,0 +1,84 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "convex_polygon.h"
+
+bool convex_polygon::is_convex(const std::vector<carve::geom2d::P2>& p)
+{
+   size_t nv = p.size();
+   if(nv < 3) return false;
+
+   // all turns must have the same strict sign, and the edge directions may change
+   // sign at most twice along each axis, which excludes self intersecting stars
+   int sign = 0;
+   size_t xflips = 0, yflips = 0;
+   double ex = p[0].x - p[nv-1].x;   // previous edge
+   double ey = p[0].y - p[nv-1].y;
+   double sx = ex, sy = ey;          // last nonzero edge direction per axis
+   for(size_t iv=0; iv<nv; iv++) {
+      const carve::geom2d::P2& p0 = p[iv];
+      const carve::geom2d::P2& p1 = p[(iv+1)%nv];
+      double dx = p1.x - p0.x;
+      double dy = p1.y - p0.y;
+
+      double cross = ex*dy - ey*dx;
+      int s = (cross > 0)? 1 : ((cross < 0)? -1 : 0);
+      if(s == 0) return false;
+      if(sign == 0) sign = s;
+      else if(s != sign) return false;
+
+      if(dx != 0) {
+         if(sx != 0 && ((dx > 0) != (sx > 0))) xflips++;
+         sx = dx;
+      }
+      if(dy != 0) {
+         if(sy != 0 && ((dy > 0) != (sy > 0))) yflips++;
+         sy = dy;
+      }
+      if(xflips > 2 || yflips > 2) return false;
+      ex = dx;
+      ey = dy;
+   }
+   return true;
+}
+
+void convex_polygon::triangulate(const std::vector<carve::geom2d::P2>& p, std::vector<carve::triangulate::tri_idx>& result)
+{
+   typedef carve::triangulate::tri_idx tri_idx;
+
+   size_t nv = p.size();
+   result.clear();
+   if(nv < 3) return;
+   result.reserve(nv-2);
+
+   if(nv == 4) {
+      // split along the shortest diagonal
+      double dx02 = p[2].x-p[0].x, dy02 = p[2].y-p[0].y;
+      double dx13 = p[3].x-p[1].x, dy13 = p[3].y-p[1].y;
+      if(dx02*dx02 + dy02*dy02 <= dx13*dx13 + dy13*dy13) {
+         result.push_back(tri_idx(0,1,2));
+         result.push_back(tri_idx(0,2,3));
+      }
+      else {
+         result.push_back(tri_idx(0,1,3));
+         result.push_back(tri_idx(1,2,3));
+      }
+      return;
+   }
+
+   for(unsigned iv=1; iv+1<nv; iv++) {
+      result.push_back(tri_idx(0,iv,iv+1));
+   }
+}
@@ -0,0 +1,38 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef CONVEX_POLYGON_H
+#define CONVEX_POLYGON_H
+
+#include <vector>
+#include <carve/csg.hpp>
+#include <carve/triangulator.hpp>
+
+// Fast path for triangulating convex faces. Most polygon faces from extrusions
+// and primitives are convex, they are fan triangulated directly and only
+// concave faces need the general carve triangulator.
+
+class convex_polygon {
+public:
+   // true if the projected polygon is strictly convex and simple, in either orientation.
+   // Polygons with collinear or repeated vertices return false
+   static bool is_convex(const std::vector<carve::geom2d::P2>& p);
+
+   // triangulate a convex polygon keeping its orientation. Quads are split
+   // along the shortest diagonal, larger polygons are fanned from the first vertex
+   static void triangulate(const std::vector<carve::geom2d::P2>& p, std::vector<carve::triangulate::tri_idx>& result);
+};
+
+#endif // CONVEX_POLYGON_H
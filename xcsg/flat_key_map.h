@@ -0,0 +1,135 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef FLAT_KEY_MAP_H
+#define FLAT_KEY_MAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// flat_key_map is an open addressing hash map from 64 bit keys to values,
+// stored in two flat arrays with linear probing. It is intended for
+// large temporary maps (edge keys, vertex pointers, grid cells) where a
+// std::map or std::unordered_map spends most of its time allocating nodes.
+// The key value ~0 is reserved and cannot be inserted. Erase is not supported.
+
+template <typename V>
+class flat_key_map {
+public:
+   static constexpr uint64_t empty_key = ~uint64_t(0);
+
+   flat_key_map(size_t expected = 0)
+   : m_size(0)
+   , m_mask(0)
+   {
+      reserve(expected);
+   }
+
+   // make room for n keys without rehashing
+   void reserve(size_t n)
+   {
+      size_t capacity = 16;
+      while(capacity < 2*n) capacity *= 2;
+      if(capacity > m_keys.size()) rehash(capacity);
+   }
+
+   size_t size() const { return m_size; }
+
+   // find or insert key. A new key gets the value init and inserted=true
+   V& insert(uint64_t key, const V& init, bool& inserted)
+   {
+      if(2*(m_size+1) > m_keys.size()) rehash(2*m_keys.size());
+
+      size_t i = hash(key) & m_mask;
+      while(true) {
+         if(m_keys[i] == key) {
+            inserted = false;
+            return m_values[i];
+         }
+         if(m_keys[i] == empty_key) {
+            m_keys[i]   = key;
+            m_values[i] = init;
+            m_size++;
+            inserted = true;
+            return m_values[i];
+         }
+         i = (i+1) & m_mask;
+      }
+   }
+
+   // find or insert key with default value
+   V& operator[](uint64_t key)
+   {
+      bool inserted = false;
+      return insert(key,V(),inserted);
+   }
+
+   // return pointer to value, or nullptr if key not found
+   const V* find(uint64_t key) const
+   {
+      size_t i = hash(key) & m_mask;
+      while(m_keys[i] != empty_key) {
+         if(m_keys[i] == key) return &m_values[i];
+         i = (i+1) & m_mask;
+      }
+      return nullptr;
+   }
+
+   // call f(key,value) for all entries, in unspecified order
+   template <typename F>
+   void for_each(F f) const
+   {
+      for(size_t i=0; i<m_keys.size(); i++) {
+         if(m_keys[i] != empty_key) f(m_keys[i],m_values[i]);
+      }
+   }
+
+   // 64 bit mixing function (splitmix64 finalizer)
+   static uint64_t hash(uint64_t key)
+   {
+      key ^= key >> 30; key *= 0xbf58476d1ce4e5b9ULL;
+      key ^= key >> 27; key *= 0x94d049bb133111ebULL;
+      key ^= key >> 31;
+      return key;
+   }
+
+private:
+   void rehash(size_t capacity)
+   {
+      std::vector<uint64_t> keys(capacity,empty_key);
+      std::vector<V>        values(capacity);
+      size_t mask = capacity-1;
+      for(size_t j=0; j<m_keys.size(); j++) {
+         if(m_keys[j] != empty_key) {
+            size_t i = hash(m_keys[j]) & mask;
+            while(keys[i] != empty_key) i = (i+1) & mask;
+            keys[i]   = m_keys[j];
+            values[i] = m_values[j];
+         }
+      }
+      m_keys.swap(keys);
+      m_values.swap(values);
+      m_mask = mask;
+   }
+
+private:
+   std::vector<uint64_t> m_keys;
+   std::vector<V>        m_values;
+   size_t                m_size;
+   size_t                m_mask;
+};
+
+#endif // FLAT_KEY_MAP_H
@@ -0,0 +1,163 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "lump_mesh.h"
+#include "run_concurrently.h"
+#include "convex_polygon.h"
+#include <carve/triangulator.hpp>
+#include <cmath>
+#include <stdexcept>
+
+lump_mesh::lump_mesh()
+: m_face_row(1,0)
+{}
+
+lump_mesh::~lump_mesh()
+{}
+
+void lump_mesh::reserve(size_t nverts, size_t nfaces, size_t ncorners)
+{
+   m_vertices.reserve(nverts);
+   m_face_row.reserve(nfaces+1);
+   m_face_ind.reserve(ncorners);
+}
+
+size_t lump_mesh::v_add(const xvertex& pos)
+{
+   size_t index = m_vertices.size();
+   m_vertices.push_back(pos);
+   return index;
+}
+
+size_t lump_mesh::f_add(const uint32_t* ind, size_t n)
+{
+   if(m_face_ind.size()+n >= UINT32_MAX) throw std::logic_error("lump_mesh::f_add, too many face vertex indices");
+   size_t index = f_size();
+   m_face_ind.insert(m_face_ind.end(),ind,ind+n);
+   m_face_row.push_back(static_cast<uint32_t>(m_face_ind.size()));
+   return index;
+}
+
+// project a planar polygon face to 2d by dropping the dominant axis of its normal,
+// keeping the counter clockwise orientation
+static void project_face(const std::vector<xvertex>& vert, const uint32_t* ind, size_t nv, std::vector<carve::geom2d::P2>& proj)
+{
+   double n[3] = {0,0,0};
+   for(size_t iv=0; iv<nv; iv++) {
+      const xvertex& p0 = vert[ind[iv]];
+      const xvertex& p1 = vert[ind[(iv+1)%nv]];
+      n[0] += (p0.y - p1.y)*(p0.z + p1.z);
+      n[1] += (p0.z - p1.z)*(p0.x + p1.x);
+      n[2] += (p0.x - p1.x)*(p0.y + p1.y);
+   }
+   size_t axis = 0;
+   if(std::fabs(n[1]) > std::fabs(n[axis])) axis = 1;
+   if(std::fabs(n[2]) > std::fabs(n[axis])) axis = 2;
+   size_t iu = (axis+1)%3;
+   size_t iw = (axis+2)%3;
+   if(n[axis] < 0) std::swap(iu,iw);
+
+   proj.resize(nv);
+   for(size_t iv=0; iv<nv; iv++) {
+      const xvertex& p = vert[ind[iv]];
+      proj[iv] = carve::geom::VECTOR(p[iu],p[iw]);
+   }
+}
+
+static bool zero_area(const xvertex& a, const xvertex& b, const xvertex& c)
+{
+   xvertex normal = carve::geom::cross(b-a,c-a);
+   return !(0.5*normal.length() > 0);
+}
+
+size_t lump_mesh::triangulate(bool improve, bool degen_check, size_t& num_dropped, size_t max_threads)
+{
+   num_dropped = 0;
+   if(triangles_only() && !degen_check) return f_size();
+
+   // faces are split in contiguous chunks, each with its own output buffer.
+   // The buffers are concatenated in chunk order afterwards
+   const size_t chunk_size = 1024;
+   size_t nface  = f_size();
+   size_t nchunk = (nface + chunk_size - 1)/chunk_size;
+
+   struct chunk_result {
+      chunk_result() : num_dropped(0) {}
+      std::vector<uint32_t> tri_ind;
+      size_t                num_dropped;
+   };
+   std::vector<chunk_result> chunks(nchunk);
+
+   run_concurrently(nchunk,[this,&chunks,chunk_size,nface,improve,degen_check](size_t ichunk) {
+
+      size_t f_begin = ichunk*chunk_size;
+      size_t f_end   = std::min(nface,f_begin+chunk_size);
+      chunk_result& chunk = chunks[ichunk];
+      size_t ncorner = m_face_row[f_end] - m_face_row[f_begin];
+      size_t nface2  = 2*(f_end-f_begin);
+      chunk.tri_ind.reserve((ncorner>nface2)? 3*(ncorner-nface2) : 0);
+
+      std::vector<carve::geom2d::P2> proj;
+      std::vector<carve::triangulate::tri_idx> result;
+      for(size_t iface=f_begin; iface<f_end; iface++) {
+         const uint32_t* ind = &m_face_ind[m_face_row[iface]];
+         size_t nv = m_face_row[iface+1] - m_face_row[iface];
+
+         result.clear();
+         if(nv == 3) {
+            result.push_back(carve::triangulate::tri_idx(0,1,2));
+         }
+         else if(nv > 3) {
+            // convex faces are fanned directly, only concave faces need the general triangulator
+            project_face(m_vertices,ind,nv,proj);
+            if(convex_polygon::is_convex(proj)) {
+               convex_polygon::triangulate(proj,result);
+            }
+            else {
+               carve::triangulate::triangulate(proj,result);
+               if(improve) carve::triangulate::improve(proj,result);
+            }
+         }
+
+         for(auto& tri : result) {
+            uint32_t a = ind[tri.a], b = ind[tri.b], c = ind[tri.c];
+            if(degen_check && zero_area(m_vertices[a],m_vertices[b],m_vertices[c])) {
+               chunk.num_dropped++;
+               continue;
+            }
+            chunk.tri_ind.push_back(a);
+            chunk.tri_ind.push_back(b);
+            chunk.tri_ind.push_back(c);
+         }
+      }
+   },max_threads);
+
+   // replace the polygon faces with triangles
+   size_t nind = 0;
+   for(auto& chunk : chunks) nind += chunk.tri_ind.size();
+   std::vector<uint32_t> tri_ind;
+   tri_ind.reserve(nind);
+   for(auto& chunk : chunks) {
+      tri_ind.insert(tri_ind.end(),chunk.tri_ind.begin(),chunk.tri_ind.end());
+      num_dropped += chunk.num_dropped;
+      std::vector<uint32_t>().swap(chunk.tri_ind);
+   }
+
+   size_t ntri = tri_ind.size()/3;
+   m_face_row.resize(ntri+1);
+   for(size_t itri=0; itri<=ntri; itri++) m_face_row[itri] = static_cast<uint32_t>(3*itri);
+   m_face_ind.swap(tri_ind);
+   return ntri;
+}
@@ -0,0 +1,71 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef LUMP_MESH_H
+#define LUMP_MESH_H
+
+#include "xshape.h"
+#include <cstdint>
+#include <vector>
+
+// lump_mesh is a lean indexed mesh of one result lump, created directly from the
+// final carve MeshSet. Face vertex indices are stored in compressed rows, so a face
+// costs no allocation. After triangulate() all faces are triangles and the mesh is
+// used as is by the exporters.
+
+class lump_mesh {
+public:
+   // read only view of a face, compatible with xface for mesh_validator and mesh_stats
+   class face_ref {
+   public:
+      face_ref(const uint32_t* ind, size_t n) : m_ind(ind), m_n(n) {}
+      size_t size() const { return m_n; }
+      size_t operator[](size_t iv) const { return m_ind[iv]; }
+   private:
+      const uint32_t* m_ind;
+      size_t          m_n;
+   };
+
+   lump_mesh();
+   virtual ~lump_mesh();
+
+   void reserve(size_t nverts, size_t nfaces, size_t ncorners);
+
+   // vertices
+   size_t         v_add(const xvertex& pos);
+   size_t         v_size() const                 { return m_vertices.size(); }
+   const xvertex& v_get(size_t v_ind) const      { return m_vertices[v_ind]; }
+
+   // faces
+   size_t         f_add(const uint32_t* ind, size_t n);
+   size_t         f_size() const                 { return m_face_row.size()-1; }
+   face_ref       f_get(size_t f_ind) const      { return face_ref(&m_face_ind[m_face_row[f_ind]],m_face_row[f_ind+1]-m_face_row[f_ind]); }
+
+   // true if all faces are triangles
+   bool           triangles_only() const         { return m_face_ind.size() == 3*f_size(); }
+
+   // triangulate the non-triangular faces in place, return number of triangles.
+   // With degen_check, zero area triangles are dropped and counted in num_dropped.
+   // Faces are triangulated in chunks on up to max_threads threads (0 = hardware threads),
+   // the result does not depend on the number of threads
+   size_t         triangulate(bool improve, bool degen_check, size_t& num_dropped, size_t max_threads = 0);
+
+private:
+   std::vector<xvertex>  m_vertices;  // vertex coordinates
+   std::vector<uint32_t> m_face_row;  // face i uses m_face_ind[m_face_row[i] .. m_face_row[i+1]>
+   std::vector<uint32_t> m_face_ind;  // vertex indices of all faces
+};
+
+#endif // LUMP_MESH_H
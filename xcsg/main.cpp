@@ -23,6 +23,10 @@ namespace bdt = boost::date_time;
 
 #include "boost_command_line.h"
 #include "xcsg_main.h"
+#include "xcsg_status.h"
+#include "cancel_token.h"
+#include "perf_counters.h"
+#include "mesh_stats.h"
 
 
 string elapsed_time(bpt::ptime time_begin, bpt::ptime time_end)
@@ -44,22 +48,66 @@ int main(int argc, char **argv)
 
    boost_command_line cmd(argc,argv);
    if(cmd.parsed_ok()) {
+
+      // machine readable status stream requested?
+      xcsg_status& status = xcsg_status::singleton();
+      if(cmd.status_fd() > 0) {
+         if(!status.open(cmd.status_fd())) {
+            cout << "xcsg error: could not open status stream on file descriptor " << cmd.status_fd() << endl;
+            return 1;
+         }
+      }
+
+      // standard output is reserved for the model data, human readable output goes to standard error
+      if(cmd.stdout_output()) cout.rdbuf(cerr.rdbuf());
+
+      // with quiet output, all formatting of human readable output is skipped
+      if(cmd.quiet()) cout.setstate(std::ios_base::badbit);
+
+      // abort cleanly on timeout or interrupt
+      cancel_token& cancel = cancel_token::singleton();
+      cancel.set_keep_partial(cmd.partial());
+      cancel.set_timeout(cmd.timeout());
+      cancel.install_signal_handlers();
+
+      // optional hardware performance counters
+      perf_registry& perf = perf_registry::singleton();
+      perf.set_enabled(cmd.perf());
+
+      // faces per primitive type are recorded while the meshes are created
+      mesh_source_stats::singleton().set_enabled(cmd.count("stats")>0);
+
       // command line parameters accepted
       try {
          xcsg_main engine(cmd);
          if(engine.run()) {
 
+            if(perf.enabled()) {
+               perf.report(cout);
+               perf.report_status();
+            }
+
             // report the elapsed time
-            cout << "xcsg finished using "<< elapsed_time(time_begin,bdt::microsec_clock<bpt::ptime>::local_time()) << endl;
+            bpt::ptime time_end = bdt::microsec_clock<bpt::ptime>::local_time();
+            cout << "xcsg finished using "<< elapsed_time(time_begin,time_end) << endl;
+            status.finished("ok","",0.001*(time_end - time_begin).total_milliseconds());
             return 0;
          }
       }
+      catch(cancel_exception& ex) {
+         cout << "xcsg cancelled: " << ex.what() << endl;
+         if(cmd.quiet()) cerr << "xcsg cancelled: " << ex.what() << endl;
+         bpt::ptime time_end = bdt::microsec_clock<bpt::ptime>::local_time();
+         status.finished("cancelled",ex.what(),0.001*(time_end - time_begin).total_milliseconds());
+         return 2;
+      }
       catch(std::exception& ex) {
          cout << "xcsg finished with exception: " << ex.what() << endl;
+         if(cmd.quiet()) cerr << "xcsg finished with exception: " << ex.what() << endl;
+         bpt::ptime time_end = bdt::microsec_clock<bpt::ptime>::local_time();
+         status.finished("error",ex.what(),0.001*(time_end - time_begin).total_milliseconds());
          return 1;
       }
    }
    return 0;
 }
-
-
@@ -0,0 +1,92 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "mesh_stats.h"
+#include "xcsg_status.h"
+#include <iomanip>
+
+lump_stats::lump_stats()
+: nvert(0)
+, nface(0)
+, degenerate(0)
+, sliver(0)
+, min_edge(std::numeric_limits<double>::max())
+, max_edge(0.0)
+, dup_clusters(0)
+, dup_vertices(0)
+{}
+
+void lump_stats::merge_faces(const lump_stats& other)
+{
+   degenerate += other.degenerate;
+   sliver     += other.sliver;
+   min_edge    = std::min(min_edge,other.min_edge);
+   max_edge    = std::max(max_edge,other.max_edge);
+}
+
+mesh_source_stats::mesh_source_stats()
+: m_enabled(false)
+{}
+
+mesh_source_stats::~mesh_source_stats()
+{}
+
+void mesh_source_stats::add(const std::string& type, size_t nface)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   for(auto& s : m_sources) {
+      if(s.type == type) {
+         s.count++;
+         s.faces    += nface;
+         s.max_faces = std::max(s.max_faces,nface);
+         return;
+      }
+   }
+   m_sources.push_back(source{type,1,nface,nface});
+}
+
+std::vector<mesh_source_stats::source> mesh_source_stats::sorted()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   std::vector<source> sources = m_sources;
+   std::sort(sources.begin(),sources.end(),[](const source& a, const source& b) { return a.faces > b.faces; });
+   return sources;
+}
+
+void mesh_source_stats::report(std::ostream& out)
+{
+   std::vector<source> sources = sorted();
+   if(sources.size() == 0) return;
+
+   size_t total = 0;
+   for(auto& s : sources) total += s.faces;
+
+   out << "...faces per source primitive type" << std::endl;
+   out << "   " << std::left << std::setw(20) << "type" << std::right << std::setw(8) << "count"
+       << std::setw(12) << "faces" << std::setw(12) << "max faces" << std::setw(8) << "%" << std::endl;
+   for(auto& s : sources) {
+      double percent = (total>0)? (100.0*s.faces)/total : 0.0;
+      out << "   " << std::left << std::setw(20) << s.type << std::right << std::setw(8) << s.count
+          << std::setw(12) << s.faces << std::setw(12) << s.max_faces
+          << std::setw(8) << std::fixed << std::setprecision(1) << percent << std::defaultfloat << std::endl;
+   }
+}
+
+void mesh_source_stats::report_status()
+{
+   for(auto& s : sorted()) {
+      xcsg_status::singleton().source(s.type,s.count,s.faces,s.max_faces);
+   }
+}
@@ -0,0 +1,268 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef MESH_STATS_H
+#define MESH_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+#include "flat_key_map.h"
+
+// quality metrics for a single lump
+struct lump_stats {
+   lump_stats();
+
+   // merge face metrics computed for a subset of faces
+   void merge_faces(const lump_stats& other);
+
+   size_t nvert;         // number of vertices
+   size_t nface;         // number of faces
+   size_t degenerate;    // faces with (near) zero area or repeated vertices
+   size_t sliver;        // faces with small area compared to the longest edge
+   double min_edge;      // shortest edge length
+   double max_edge;      // longest edge length
+   size_t dup_clusters;  // clusters of near duplicate vertices
+   size_t dup_vertices;  // number of vertices in such clusters
+};
+
+// mesh_stats computes lump_stats in O(n) using flat arrays. The face pass is split
+// over threads while the near duplicate vertex clustering runs on the calling thread.
+//
+// The Mesh type provides v_size(), v_get(i) returning a vertex with x,y,z members,
+// f_size() and f_get(i) returning a face with size() and operator[] giving vertex indices.
+
+class mesh_stats {
+public:
+   // face area below sliver_ratio*(longest edge)^2 is a sliver (equilateral triangle: 0.433)
+   static constexpr double sliver_ratio     = 1.0E-2;
+
+   // face area below degenerate_ratio*(longest edge)^2 is degenerate
+   static constexpr double degenerate_ratio = 1.0E-12;
+
+   // vertices closer than duplicate_ratio*(bounding box diagonal) are near duplicates
+   static constexpr double duplicate_ratio  = 1.0E-6;
+
+   template <typename Mesh>
+   static lump_stats compute(const Mesh& mesh);
+
+private:
+   template <typename Mesh>
+   static void face_pass(const Mesh& mesh, size_t f_begin, size_t f_end, lump_stats& stats);
+
+   template <typename Mesh>
+   static void cluster_pass(const Mesh& mesh, lump_stats& stats);
+
+   static size_t find_root(std::vector<size_t>& parent, size_t i)
+   {
+      while(parent[i] != i) {
+         parent[i] = parent[parent[i]];
+         i = parent[i];
+      }
+      return i;
+   }
+};
+
+// mesh_source_stats collects the number of faces in each primitive mesh entering the booleans,
+// summed per primitive type. Nothing is recorded unless enabled.
+
+class mesh_source_stats {
+public:
+   static mesh_source_stats& singleton()  { static mesh_source_stats instance; return instance;  }
+
+   void set_enabled(bool enabled) { m_enabled = enabled; }
+   bool enabled() const           { return m_enabled; }
+
+   // record a primitive mesh of the given type
+   void add(const std::string& type, size_t nface);
+
+   // write summary sorted by face count, largest first
+   void report(std::ostream& out);
+
+   // write one status stream event per primitive type
+   void report_status();
+
+protected:
+   mesh_source_stats();
+   virtual ~mesh_source_stats();
+
+private:
+   struct source {
+      std::string type;
+      size_t      count;     // number of primitive meshes
+      size_t      faces;     // total faces
+      size_t      max_faces; // largest single mesh
+   };
+   std::vector<source> sorted();
+
+   bool                m_enabled;
+   std::mutex          m_mutex;
+   std::vector<source> m_sources;
+};
+
+template <typename Mesh>
+lump_stats mesh_stats::compute(const Mesh& mesh)
+{
+   lump_stats stats;
+   stats.nvert = mesh.v_size();
+   stats.nface = mesh.f_size();
+
+   // face pass in chunks, one per thread
+   const size_t chunk_min = 20000;
+   size_t nthreads = std::max(size_t(1),std::min(size_t(boost::thread::hardware_concurrency()),1+stats.nface/chunk_min));
+   size_t chunk    = 1 + stats.nface/nthreads;
+
+   std::vector<lump_stats>  chunk_stats(nthreads);
+   std::list<boost::thread> threads;
+   for(size_t ithread=0; ithread<nthreads; ithread++) {
+      size_t f_begin = std::min(ithread*chunk,stats.nface);
+      size_t f_end   = std::min(f_begin+chunk,stats.nface);
+      lump_stats* cs = &chunk_stats[ithread];
+      threads.push_back(boost::thread([&mesh,f_begin,f_end,cs]() { face_pass(mesh,f_begin,f_end,*cs); }));
+   }
+
+   // vertex clustering meanwhile
+   cluster_pass(mesh,stats);
+
+   for(auto& t : threads) t.join();
+   for(auto& cs : chunk_stats) stats.merge_faces(cs);
+   if(stats.min_edge > stats.max_edge) stats.min_edge = stats.max_edge = 0.0;
+
+   return stats;
+}
+
+template <typename Mesh>
+void mesh_stats::face_pass(const Mesh& mesh, size_t f_begin, size_t f_end, lump_stats& stats)
+{
+   for(size_t iface=f_begin; iface<f_end; iface++) {
+      const auto& face = mesh.f_get(iface);
+      size_t nv = face.size();
+
+      // Newell normal gives twice the area vector for any planar polygon
+      double nx=0,ny=0,nz=0;
+      double max_edge2 = 0.0;
+      bool repeated = (nv < 3);
+      for(size_t iv=0; iv<nv; iv++) {
+         size_t i0 = face[iv];
+         size_t i1 = face[(iv+1)%nv];
+         if(i0 == i1) repeated = true;
+
+         const auto& p0 = mesh.v_get(i0);
+         const auto& p1 = mesh.v_get(i1);
+         nx += (p0.y - p1.y)*(p0.z + p1.z);
+         ny += (p0.z - p1.z)*(p0.x + p1.x);
+         nz += (p0.x - p1.x)*(p0.y + p1.y);
+
+         double dx = p1.x-p0.x, dy = p1.y-p0.y, dz = p1.z-p0.z;
+         double len2 = dx*dx + dy*dy + dz*dz;
+         max_edge2 = std::max(max_edge2,len2);
+         double len = std::sqrt(len2);
+         stats.min_edge = std::min(stats.min_edge,len);
+         stats.max_edge = std::max(stats.max_edge,len);
+      }
+
+      double area = 0.5*std::sqrt(nx*nx + ny*ny + nz*nz);
+      if(repeated || area <= degenerate_ratio*max_edge2) stats.degenerate++;
+      else if(area < sliver_ratio*max_edge2)             stats.sliver++;
+   }
+}
+
+template <typename Mesh>
+void mesh_stats::cluster_pass(const Mesh& mesh, lump_stats& stats)
+{
+   size_t nvert = mesh.v_size();
+   if(nvert < 2) return;
+
+   // bounding box
+   double xmin =  std::numeric_limits<double>::max(), ymin=xmin, zmin=xmin;
+   double xmax = -std::numeric_limits<double>::max(), ymax=xmax, zmax=xmax;
+   for(size_t iv=0; iv<nvert; iv++) {
+      const auto& p = mesh.v_get(iv);
+      xmin = std::min(xmin,p.x); ymin = std::min(ymin,p.y); zmin = std::min(zmin,p.z);
+      xmax = std::max(xmax,p.x); ymax = std::max(ymax,p.y); zmax = std::max(zmax,p.z);
+   }
+   double dx = xmax-xmin, dy = ymax-ymin, dz = zmax-zmin;
+   double tol = duplicate_ratio*std::sqrt(dx*dx + dy*dy + dz*dz);
+   if(tol <= 0.0) return;
+
+   // uniform grid with cell size >= tol, at most 2^21 cells per axis so cell indices pack into 63 bits.
+   // Near duplicates are then in the same or neighbouring cells
+   const double max_cells = double(1<<21) - 2;
+   double cell = std::max(tol,std::max(dx,std::max(dy,dz))/max_cells);
+   auto cell_index = [&](double v, double vmin) { return static_cast<uint64_t>((v-vmin)/cell) + 1; };
+   auto cell_key   = [](uint64_t ix, uint64_t iy, uint64_t iz) { return ix | (iy<<21) | (iz<<42); };
+
+   // vertices in each cell as linked lists, head in hash map and next in flat array
+   const size_t none = std::numeric_limits<size_t>::max();
+   flat_key_map<size_t> head(nvert);
+   std::vector<size_t>  next(nvert,none);
+   std::vector<uint64_t> ixyz(3*nvert);
+   for(size_t iv=0; iv<nvert; iv++) {
+      const auto& p = mesh.v_get(iv);
+      uint64_t ix = ixyz[3*iv]   = cell_index(p.x,xmin);
+      uint64_t iy = ixyz[3*iv+1] = cell_index(p.y,ymin);
+      uint64_t iz = ixyz[3*iv+2] = cell_index(p.z,zmin);
+      bool inserted = false;
+      size_t& h = head.insert(cell_key(ix,iy,iz),iv,inserted);
+      if(!inserted) {
+         next[iv] = h;
+         h = iv;
+      }
+   }
+
+   // union vertices within tolerance
+   std::vector<size_t> parent(nvert);
+   for(size_t iv=0; iv<nvert; iv++) parent[iv] = iv;
+
+   double tol2 = tol*tol;
+   for(size_t iv=0; iv<nvert; iv++) {
+      const auto& p = mesh.v_get(iv);
+      for(uint64_t kx=ixyz[3*iv]-1; kx<=ixyz[3*iv]+1; kx++) {
+         for(uint64_t ky=ixyz[3*iv+1]-1; ky<=ixyz[3*iv+1]+1; ky++) {
+            for(uint64_t kz=ixyz[3*iv+2]-1; kz<=ixyz[3*iv+2]+1; kz++) {
+               const size_t* h = head.find(cell_key(kx,ky,kz));
+               for(size_t jv = (h)? *h : none; jv!=none; jv=next[jv]) {
+                  if(jv <= iv) continue;
+                  const auto& q = mesh.v_get(jv);
+                  double ex = q.x-p.x, ey = q.y-p.y, ez = q.z-p.z;
+                  if(ex*ex + ey*ey + ez*ez <= tol2) {
+                     size_t ri = find_root(parent,iv);
+                     size_t rj = find_root(parent,jv);
+                     if(ri != rj) parent[std::max(ri,rj)] = std::min(ri,rj);
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   // count clusters with more than one vertex
+   std::vector<size_t> csize(nvert,0);
+   for(size_t iv=0; iv<nvert; iv++) csize[find_root(parent,iv)]++;
+   for(size_t iv=0; iv<nvert; iv++) {
+      if(csize[iv] > 1) {
+         stats.dup_clusters++;
+         stats.dup_vertices += csize[iv];
+      }
+   }
+}
+
+#endif // MESH_STATS_H
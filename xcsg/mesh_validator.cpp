@@ -0,0 +1,53 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "mesh_validator.h"
+
+mesh_check::mesh_check()
+: nedge(0)
+, nerr(0)
+, nc1(0)
+, nonmanifold_edges(0)
+, orientation_conflicts(0)
+, nonmanifold_vertices(0)
+, face_error(0)
+, num_non_tri(0)
+{}
+
+void mesh_check::report(std::ostream& out) const
+{
+   if(nerr == 0) {
+      out << "...Polyhedron is water-tight (edge use-count check OK)" << std::endl;
+   }
+   else {
+      out << ">>> Warning: Polyhedron is not water-tight, it has " << nedge << " edges, " << nerr << " with wrong use count, " << nc1 << " with use-count==1";
+      if(nonmanifold_edges > 0) out << ", " << nonmanifold_edges << " with use-count>2";
+      out << std::endl;
+   }
+   if(orientation_conflicts > 0) {
+      out << ">>> Warning: Polyhedron has " << orientation_conflicts << " edges with orientation conflicts" << std::endl;
+   }
+   if(nonmanifold_vertices > 0) {
+      out << ">>> Warning: Polyhedron has " << nonmanifold_vertices << " non-manifold vertices" << std::endl;
+   }
+   if(face_error == 0) {
+      out << "...Polyhedron has no degenerated faces (face area check OK)" << std::endl;
+   }
+   else {
+      out << ">>> Warning: Polyhedron has " << face_error << " zero area faces." << std::endl;
+   }
+
+   out << "...Polyhedron has "<< num_non_tri << " non-triangular faces" << std::endl;
+}
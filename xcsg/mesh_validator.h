@@ -0,0 +1,223 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef MESH_VALIDATOR_H
+#define MESH_VALIDATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// result of a mesh_validator check
+struct mesh_check {
+   mesh_check();
+
+   // write the check results as console messages
+   void report(std::ostream& out) const;
+
+   // true if every edge is used exactly twice and no face has zero area
+   bool ok() const { return (nerr+face_error) == 0; }
+
+   size_t nedge;                 // number of unique edges
+   size_t nerr;                  // edges with use count != 2
+   size_t nc1;                   // edges with use count == 1 (boundary edges)
+   size_t nonmanifold_edges;     // edges with use count > 2
+   size_t orientation_conflicts; // edges used twice in the same direction
+   size_t nonmanifold_vertices;  // vertices where the faces do not form a single fan
+   size_t face_error;            // faces with zero area
+   size_t num_non_tri;           // non-triangular faces
+};
+
+// mesh_validator checks that a mesh is water-tight in linear time, using flat arrays only.
+// Face edges are bucketed by their lowest vertex index (counting sort) as packed 64 bit keys
+// (highest vertex index and direction), and each short bucket is sorted so equal edges
+// become adjacent. Vertex indices are 32 bit, so 10M+ vertices are no problem.
+// Each edge keeps a signed count of its directed uses, which must cancel for a consistently
+// oriented manifold. For non-manifold vertices, the face corners around each vertex are
+// grouped into fans connected via shared edges.
+//
+// The Mesh type provides v_size(), v_get(i) returning a vertex with x,y,z members,
+// f_size() and f_get(i) returning a face with size() and operator[] giving vertex indices.
+
+class mesh_validator {
+public:
+   template <typename Mesh>
+   static mesh_check check(const Mesh& mesh);
+
+private:
+   struct edge_use {
+      edge_use() : count(0), directed(0) {}
+      uint32_t count;     // number of faces using the edge
+      int32_t  directed;  // +1 for each use min->max, -1 for each use max->min
+   };
+
+   // number of non-manifold vertices, given corners (vertex, previous vertex, next vertex)
+   template <typename Mesh>
+   static size_t count_nonmanifold_vertices(const Mesh& mesh);
+
+   static size_t find_root(std::vector<uint32_t>& parent, size_t i)
+   {
+      while(parent[i] != i) {
+         parent[i] = parent[parent[i]];
+         i = parent[i];
+      }
+      return i;
+   }
+};
+
+template <typename Mesh>
+mesh_check mesh_validator::check(const Mesh& mesh)
+{
+   mesh_check result;
+
+   size_t nvert = mesh.v_size();
+   size_t nface = mesh.f_size();
+   if(uint64_t(nvert) >= (uint64_t(1)<<32)) throw std::logic_error("mesh_validator: too many vertices " + std::to_string(nvert));
+
+   size_t ncorner = 0;
+   for(size_t iface=0; iface<nface; iface++) ncorner += mesh.f_get(iface).size();
+
+   // face pass: count edges per lowest vertex index and check face areas
+   std::vector<uint32_t> row(nvert+1,0);
+   for(size_t iface=0; iface<nface; iface++) {
+      const auto& face = mesh.f_get(iface);
+      size_t nv = face.size();
+      result.num_non_tri += (nv!=3)? 1 : 0;
+
+      double nx=0,ny=0,nz=0;
+      for(size_t iv=0; iv<nv; iv++) {
+         size_t iv0 = face[iv];
+         size_t iv1 = face[(iv+1)%nv];
+         row[std::min(iv0,iv1)+1]++;
+
+         const auto& p0 = mesh.v_get(iv0);
+         const auto& p1 = mesh.v_get(iv1);
+         nx += (p0.y - p1.y)*(p0.z + p1.z);
+         ny += (p0.z - p1.z)*(p0.x + p1.x);
+         nz += (p0.x - p1.x)*(p0.y + p1.y);
+      }
+      if(!(0.5*std::sqrt(nx*nx + ny*ny + nz*nz) > 0.0)) result.face_error++;
+   }
+   for(size_t iv=0; iv<nvert; iv++) row[iv+1] += row[iv];
+
+   // bucket the packed edge keys (max vertex<<1 | direction) by lowest vertex
+   std::vector<uint64_t> keys(ncorner);
+   std::vector<uint32_t> fill(row.begin(),row.end()-1);
+   for(size_t iface=0; iface<nface; iface++) {
+      const auto& face = mesh.f_get(iface);
+      size_t nv = face.size();
+      for(size_t iv=0; iv<nv; iv++) {
+         uint64_t iv0 = face[iv];
+         uint64_t iv1 = face[(iv+1)%nv];
+         if(iv0 < iv1) keys[fill[iv0]++] = (iv1<<1) | 1;
+         else          keys[fill[iv1]++] = (iv0<<1);
+      }
+   }
+
+   // sort each (short) bucket, equal edges are then adjacent
+   for(size_t iv=0; iv<nvert; iv++) {
+      auto first = keys.begin()+row[iv];
+      auto last  = keys.begin()+row[iv+1];
+      std::sort(first,last);
+      for(auto i=first; i!=last; ) {
+         uint64_t vmax = (*i)>>1;
+         edge_use e;
+         for(; i!=last && ((*i)>>1)==vmax; ++i) {
+            e.count++;
+            e.directed += ((*i)&1)? 1 : -1;
+         }
+         result.nedge++;
+         if(e.count != 2) {
+            result.nerr++;
+            if(e.count == 1) result.nc1++;
+            else if(e.count > 2) result.nonmanifold_edges++;
+         }
+         else if(e.directed != 0) {
+            result.orientation_conflicts++;
+         }
+      }
+   }
+
+   result.nonmanifold_vertices = count_nonmanifold_vertices(mesh);
+   return result;
+}
+
+template <typename Mesh>
+size_t mesh_validator::count_nonmanifold_vertices(const Mesh& mesh)
+{
+   size_t nvert = mesh.v_size();
+   size_t nface = mesh.f_size();
+
+   // corners per vertex in compressed rows: first count, then fill
+   std::vector<uint32_t> row(nvert+1,0);
+   for(size_t iface=0; iface<nface; iface++) {
+      const auto& face = mesh.f_get(iface);
+      for(size_t iv=0; iv<face.size(); iv++) row[face[iv]+1]++;
+   }
+   for(size_t iv=0; iv<nvert; iv++) row[iv+1] += row[iv];
+
+   // each corner stores the previous and next vertex in its face
+   std::vector<std::pair<uint32_t,uint32_t>> corners(row[nvert]);
+   std::vector<uint32_t> fill(row.begin(),row.end()-1);
+   for(size_t iface=0; iface<nface; iface++) {
+      const auto& face = mesh.f_get(iface);
+      size_t nv = face.size();
+      for(size_t iv=0; iv<nv; iv++) {
+         uint32_t prev = static_cast<uint32_t>(face[(iv+nv-1)%nv]);
+         uint32_t next = static_cast<uint32_t>(face[(iv+1)%nv]);
+         corners[fill[face[iv]]++] = std::make_pair(prev,next);
+      }
+   }
+
+   // for each vertex, corners sharing an edge (same neighbour vertex) belong to the same fan
+   size_t nonmanifold = 0;
+   std::vector<std::pair<uint32_t,uint32_t>> neighbours;  // (neighbour vertex, local corner)
+   std::vector<uint32_t> parent;
+   for(size_t iv=0; iv<nvert; iv++) {
+      uint32_t c0 = row[iv];
+      uint32_t nc = row[iv+1] - c0;
+      if(nc < 2) continue;
+
+      neighbours.clear();
+      parent.resize(nc);
+      for(uint32_t ic=0; ic<nc; ic++) {
+         parent[ic] = ic;
+         neighbours.push_back(std::make_pair(corners[c0+ic].first,ic));
+         neighbours.push_back(std::make_pair(corners[c0+ic].second,ic));
+      }
+      std::sort(neighbours.begin(),neighbours.end());
+
+      size_t nfan = nc;
+      for(size_t i=1; i<neighbours.size(); i++) {
+         if(neighbours[i].first == neighbours[i-1].first) {
+            size_t ra = find_root(parent,neighbours[i].second);
+            size_t rb = find_root(parent,neighbours[i-1].second);
+            if(ra != rb) {
+               parent[std::max(ra,rb)] = static_cast<uint32_t>(std::min(ra,rb));
+               nfan--;
+            }
+         }
+      }
+      if(nfan > 1) nonmanifold++;
+   }
+   return nonmanifold;
+}
+
+#endif // MESH_VALIDATOR_H
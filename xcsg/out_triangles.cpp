@@ -14,36 +14,41 @@
 // EndLicense:
 
 #include "out_triangles.h"
-#include <carve/poly.hpp>
+#include "lump_mesh.h"
+#include "run_concurrently.h"
+#include "text_buffer.h"
+#include <cstdio>
+#include <cstring>
+#include <functional>
 #include <fstream>
+#include <iomanip>
+#include <sstream>
 #include "std_filename.h"
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/convenience.hpp>
 
-out_triangles::out_triangles(std::shared_ptr<poly_vector> polyset)
-: m_polyset(polyset)
+#ifdef _MSC_VER
+   #include <io.h>
+   #include <fcntl.h>
+#endif
+
+out_triangles::out_triangles(std::shared_ptr<lump_vector> lumps)
+: m_lumps(lumps)
 {}
 
 out_triangles::~out_triangles()
 {}
 
-static double face_area(std::vector<carve::geom::vector<3>>& p)
-{
-   // https://en.wikipedia.org/wiki/Heron's_formula
-   double a = (p[1] - p[0]).length();
-   double b = (p[2] - p[1]).length();
-   double c = (p[0] - p[2]).length();
-   double s = 0.5*(a+b+c);
-   return sqrt(s*(s-a)*(s-b)*(s-c));
-}
-
 std::string out_triangles::write_stl(const std::string& xcsg_path, bool binary)
 {
    if(binary)return write_stl_binary(xcsg_path);
    else      return write_stl_ascii(xcsg_path);
 }
 
+// vertices and faces are formatted in blocks of this size
+static const size_t text_block_size = 16384;
+
 std::string  out_triangles::write_csg(const std::string& xcsg_path)
 {
    boost::filesystem::path fullpath(xcsg_path);
@@ -53,53 +58,52 @@ std::string  out_triangles::write_csg(const std::string& xcsg_path)
    // fix inconsistent slashes to something that is consistent and works everytwhere
    std::replace(path.begin(),path.end(), '\\', '/');
 
-   std::ofstream out(path);
+   std::ofstream out(path,std::ios::binary);
 
-   out << "// OpenSCAD file created by xcsg : " << path << std::endl;;
-   out << "union() {" << std::endl;
+   out << "// OpenSCAD file created by xcsg : " << path << '\n';
+   out << "union() {" << '\n';
 
-      for(size_t ipoly=0; ipoly<m_polyset->size(); ipoly++) {
+      for(size_t ilump=0; ilump<m_lumps->size(); ilump++) {
 
-         std::shared_ptr<carve::poly::Polyhedron> poly = (*m_polyset)[ipoly];
-         std::vector<carve::poly::Geometry<3>::vertex_t>& vertices = poly->vertices;
+         const lump_mesh& lump = *(*m_lumps)[ilump];
 
          out << "\tpolyhedron( ";
 
          // ========= points / vertices =================
          out << " points=[ ";
-         for(size_t ivert=0; ivert<vertices.size(); ivert++) {
-            carve::poly::Geometry<3>::vertex_t& vtx = vertices[ivert];
-            if(ivert > 0) out << ',';
-            out << '[' << std::setprecision(16) << vtx.v[0] << ',' << std::setprecision(16) << vtx.v[1] << ',' << std::setprecision(16) <<  vtx.v[2] << ']';
-         }
+         text_buffer::write_blocks(out,lump.v_size(),text_block_size,[&lump](size_t v_begin, size_t v_end, text_buffer& buf) {
+            for(size_t ivert=v_begin; ivert<v_end; ivert++) {
+               const xvertex& vtx = lump.v_get(ivert);
+               if(ivert > 0) buf.put(',');
+               buf.put('[').put(vtx.x).put(',').put(vtx.y).put(',').put(vtx.z).put(']');
+            }
+         });
          out << "],";
 
          // ========= faces =================
          out << " faces=[ ";
-         for(size_t iface = 0; iface<poly->faces.size(); ++iface) {
-            carve::poly::Face<3>& face = poly->faces[iface];
-
-            size_t nvert = face.nVertices();
-            if(nvert != 3)throw std::logic_error("carve_triangulate:: detected non-triangular face after triangulation!");
-            if(iface > 0) out << ',';
-            out << '[';
-            std::vector<const carve::poly::Polyhedron::vertex_t *> vloop;
-            poly->faces[iface].getVertexLoop(vloop);
-            for(size_t ivert=0; ivert<nvert; ivert++) {
-               if(ivert > 0) out << ',';
-               size_t index = poly->vertexToIndex(vloop[2-ivert]); // reverse vertex order in OpenSCAD
-               out << index;
+         text_buffer::write_blocks(out,lump.f_size(),text_block_size,[&lump](size_t f_begin, size_t f_end, text_buffer& buf) {
+            for(size_t iface=f_begin; iface<f_end; iface++) {
+               lump_mesh::face_ref face = lump.f_get(iface);
+
+               size_t nvert = face.size();
+               if(nvert != 3)throw std::logic_error("carve_triangulate:: detected non-triangular face after triangulation!");
+               if(iface > 0) buf.put(',');
+               buf.put('[');
+               for(size_t ivert=0; ivert<nvert; ivert++) {
+                  if(ivert > 0) buf.put(',');
+                  buf.put(uint64_t(face[2-ivert])); // reverse vertex order in OpenSCAD
+               }
+               buf.put(']');
             }
-            out << ']';
-         }
+         });
          out << "] ";
 
-         out << ");" << std::endl;
+         out << ");" << '\n';
       }
 
-   out << "};" << std::endl;
+   out << "};" << '\n';
 
-   m_files_written.insert(path);
    return path;
 }
 
@@ -111,48 +115,47 @@ std::string out_triangles::write_off(const std::string& xcsg_path)
 
    std::string path;
 
-   for(size_t ipoly=0; ipoly<m_polyset->size(); ipoly++) {
+   for(size_t ilump=0; ilump<m_lumps->size(); ilump++) {
 
       std::ostringstream postfix;
-      if(ipoly > 0)postfix << '_' << ipoly;
+      if(ilump > 0)postfix << '_' << ilump;
       postfix << ".off";
 
       path = csg_path.string() + postfix.str();
       std::replace(path.begin(),path.end(), '\\', '/');
 
-      std::ofstream out(path);
+      std::ofstream out(path,std::ios::binary);
 
-      std::shared_ptr<carve::poly::Polyhedron> poly = (*m_polyset)[ipoly];
-      std::vector<carve::poly::Geometry<3>::vertex_t>& vertices = poly->vertices;
+      const lump_mesh& lump = *(*m_lumps)[ilump];
 
-      out << "OFF " << std::endl;
+      out << "OFF " << '\n';
   // OFF comment line not supported by tetgen
   //    out << "# OFF file created by xcsg : " << path << std::endl;
-      out << poly->vertices.size() << ' ' << poly->faces.size() << " 0 " <<  std::endl;  // numedges always zero
+      out << lump.v_size() << ' ' << lump.f_size() << " 0 " <<  '\n';  // numedges always zero
 
       // ========= vertices =================
-      for(size_t ivert=0; ivert<vertices.size(); ivert++) {
-         carve::poly::Geometry<3>::vertex_t& vtx = vertices[ivert];
-         out << std::setprecision(16) << vtx.v[0] << ' ' << std::setprecision(16) << vtx.v[1] << ' ' << std::setprecision(16) <<  vtx.v[2] << std::endl;
-      }
+      text_buffer::write_blocks(out,lump.v_size(),text_block_size,[&lump](size_t v_begin, size_t v_end, text_buffer& buf) {
+         for(size_t ivert=v_begin; ivert<v_end; ivert++) {
+            const xvertex& vtx = lump.v_get(ivert);
+            buf.put(vtx.x).put(' ').put(vtx.y).put(' ').put(vtx.z).put('\n');
+         }
+      });
 
       // ========= faces =================
-      for(size_t iface = 0; iface<poly->faces.size(); ++iface) {
-         carve::poly::Face<3>& face = poly->faces[iface];
-
-         size_t nvert = face.nVertices();
-         std::vector<const carve::poly::Polyhedron::vertex_t *> vloop;
-         poly->faces[iface].getVertexLoop(vloop);
-         out << nvert << ' ';
-         for(size_t ivert=0; ivert<nvert; ivert++) {
-            size_t index = poly->vertexToIndex(vloop[ivert]);
-            out << index << ' ';
+      text_buffer::write_blocks(out,lump.f_size(),text_block_size,[&lump](size_t f_begin, size_t f_end, text_buffer& buf) {
+         for(size_t iface=f_begin; iface<f_end; iface++) {
+            lump_mesh::face_ref face = lump.f_get(iface);
+
+            size_t nvert = face.size();
+            buf.put(uint64_t(nvert)).put(' ');
+            for(size_t ivert=0; ivert<nvert; ivert++) {
+               buf.put(uint64_t(face[ivert])).put(' ');
+            }
+            buf.put('\n');
          }
-         out << std::endl;
-      }
+      });
    }
 
-   m_files_written.insert(path);
    return path;
 }
 
@@ -163,50 +166,49 @@ std::string out_triangles::write_obj(const std::string& xcsg_path)
    boost::filesystem::path csg_path = fullpath.parent_path() / fullpath.stem();
    std::string path = csg_path.string() + ".obj";
    std::replace(path.begin(),path.end(), '\\', '/');
-   std::ofstream out(path);
+   std::ofstream out(path,std::ios::binary);
    std::string object_id = fullpath.stem().string();
 
-   out << "# OBJ file created by xcsg : " << path << std::endl;
-   out  << "o " << object_id << std::endl;
+   out << "# OBJ file created by xcsg : " << path << '\n';
+   out  << "o " << object_id << '\n';
 
    // ========= vertices =================
-   for(size_t ipoly=0; ipoly<m_polyset->size(); ipoly++) {
+   for(size_t ilump=0; ilump<m_lumps->size(); ilump++) {
 
-      std::shared_ptr<carve::poly::Polyhedron> poly = (*m_polyset)[ipoly];
-      std::vector<carve::poly::Geometry<3>::vertex_t>& vertices = poly->vertices;
+      const lump_mesh& lump = *(*m_lumps)[ilump];
 
-      for(size_t ivert=0; ivert<vertices.size(); ivert++) {
-         carve::poly::Geometry<3>::vertex_t& vtx = vertices[ivert];
-         out << "v " << std::setprecision(16) << vtx.v[0] << ' ' << std::setprecision(16) << vtx.v[1] << ' ' << std::setprecision(16) <<  vtx.v[2] << std::endl;
-      }
+      text_buffer::write_blocks(out,lump.v_size(),text_block_size,[&lump](size_t v_begin, size_t v_end, text_buffer& buf) {
+         for(size_t ivert=v_begin; ivert<v_end; ivert++) {
+            const xvertex& vtx = lump.v_get(ivert);
+            buf.put("v ").put(vtx.x).put(' ').put(vtx.y).put(' ').put(vtx.z).put('\n');
+         }
+      });
    }
 
    // ========= faces =================
    size_t vertex_offset = 0;
-   for(size_t ipoly=0; ipoly<m_polyset->size(); ipoly++) {
+   for(size_t ilump=0; ilump<m_lumps->size(); ilump++) {
 
-      std::shared_ptr<carve::poly::Polyhedron> poly = (*m_polyset)[ipoly];
-      std::vector<carve::poly::Geometry<3>::vertex_t>& vertices = poly->vertices;
+      const lump_mesh& lump = *(*m_lumps)[ilump];
 
-      for(size_t iface = 0; iface<poly->faces.size(); ++iface) {
-         carve::poly::Face<3>& face = poly->faces[iface];
+      text_buffer::write_blocks(out,lump.f_size(),text_block_size,[&lump,vertex_offset](size_t f_begin, size_t f_end, text_buffer& buf) {
+         for(size_t iface=f_begin; iface<f_end; iface++) {
+            lump_mesh::face_ref face = lump.f_get(iface);
 
-         size_t nvert = face.nVertices();
-         std::vector<const carve::poly::Polyhedron::vertex_t *> vloop;
-         poly->faces[iface].getVertexLoop(vloop);
-         out << "f ";
-         for(size_t ivert=0; ivert<nvert; ivert++) {
-            size_t index = poly->vertexToIndex(vloop[ivert]);
+            size_t nvert = face.size();
+            buf.put("f ");
+            for(size_t ivert=0; ivert<nvert; ivert++) {
+               size_t index = face[ivert];
 
-            // indices are 1-based in OBJ
-            out << vertex_offset + 1+index << ' ';
+               // indices are 1-based in OBJ
+               buf.put(uint64_t(vertex_offset + 1+index)).put(' ');
+            }
+            buf.put('\n');
          }
-         out << std::endl;
-      }
+      });
 
-      vertex_offset += vertices.size();
+      vertex_offset += lump.v_size();
    }
-   m_files_written.insert(path);
    return path;
 }
 
@@ -219,176 +221,294 @@ std::string  out_triangles::write_stl_ascii(const std::string& file_path)
    // fix inconsistent slashes to something that is consistent and works everytwhere
    std::replace(path.begin(),path.end(), '\\', '/');
 
-   std::ofstream out(path);
+   std::ofstream out(path,std::ios::binary);
    if(out.is_open()) {
 
-      out << "solid xcsg " << std::endl;
+      out << "solid xcsg " << '\n';
 
-      for(size_t ipoly=0; ipoly<m_polyset->size(); ipoly++) {
-         std::shared_ptr<carve::poly::Polyhedron> poly = (*m_polyset)[ipoly];
-         std::vector<carve::poly::Geometry<3>::vertex_t>& vertices = poly->vertices;
+      for(size_t ilump=0; ilump<m_lumps->size(); ilump++) {
+         const lump_mesh& lump = *(*m_lumps)[ilump];
 
-         size_t nfaces = poly->faces.size();
-         for(size_t iface=0; iface< nfaces; iface++) {
+         text_buffer::write_blocks(out,lump.f_size(),text_block_size,[&lump](size_t f_begin, size_t f_end, text_buffer& buf) {
+            for(size_t iface=f_begin; iface<f_end; iface++) {
 
-            size_t nv = poly->faces[iface].nVertices();
-            if(nv != 3)throw std::logic_error("out_triangles:: detected non-triangular face after triangulation!");
-
-            typedef carve::geom::vector<3> vec3d;
-            std::vector<vec3d> p;
-            p.reserve(3);
-            std::vector<const carve::poly::Polyhedron::vertex_t *> vloop;
-            poly->faces[iface].getVertexLoop(vloop);
-            for(size_t ivert=0; ivert<nv; ivert++) {
-               size_t index = poly->vertexToIndex(vloop[ivert]);
-               carve::poly::Geometry<3>::vertex_t& vtx = vertices[index];
-               p.push_back(carve::geom::VECTOR(vtx.v[0],vtx.v[1],vtx.v[2]));
-            }
+               lump_mesh::face_ref face = lump.f_get(iface);
+               size_t nv = face.size();
+               if(nv != 3)throw std::logic_error("out_triangles:: detected non-triangular face after triangulation!");
 
-            vec3d x = p[1] - p[0];
-            vec3d y = p[2] - p[0];
-            vec3d z = carve::geom::cross(x,y);
-            double len = sqrt(z[0]*z[0] + z[1]*z[1] + z[2]*z[2]);
+               typedef carve::geom::vector<3> vec3d;
+               const vec3d p[3] = { lump.v_get(face[0]), lump.v_get(face[1]), lump.v_get(face[2]) };
 
-            // facet normal does not require high precision, it is usually ignored, so we save some space instead
-            if(len > 0) out << "facet normal "
-                            << std::setprecision(8) << z[0]/len << ' '
-                            << std::setprecision(8) << z[1]/len << ' '
-                            << std::setprecision(8) << z[2]/len << std::endl;
-            else        out << "facet normal 0 0 0" << std::endl;
+               vec3d x = p[1] - p[0];
+               vec3d y = p[2] - p[0];
+               vec3d z = carve::geom::cross(x,y);
+               double len = sqrt(z[0]*z[0] + z[1]*z[1] + z[2]*z[2]);
 
+               // facet normal does not require high precision, it is usually ignored, so we save some space instead
+               if(len > 0) buf.put("facet normal ")
+                              .put(z[0]/len,8).put(' ')
+                              .put(z[1]/len,8).put(' ')
+                              .put(z[2]/len,8).put('\n');
+               else        buf.put("facet normal 0 0 0\n");
 
-            out << "\touter loop" << std::endl;
-            for(size_t iv=0;iv<nv;iv++) {
-
-               out << "\t\tvertex "<< std::setprecision(16) << p[iv].x <<
-                               ' ' << std::setprecision(16) << p[iv].y <<
-                               ' ' << std::setprecision(16) << p[iv].z << std::endl;
+               buf.put("\touter loop\n");
+               for(size_t iv=0;iv<nv;iv++) {
+                  buf.put("\t\tvertex ").put(p[iv].x).put(' ').put(p[iv].y).put(' ').put(p[iv].z).put('\n');
+               }
+               buf.put("\tendloop\n");
+               buf.put("endfacet\n");
             }
-            out << "\tendloop" << std::endl;
-            out << "endfacet" << std::endl;
-         }
+         });
       }
-      out << "endsolid" << std::endl;
+      out << "endsolid" << '\n';
    }
    else {
       std::string message = "stl_io::write_ascii(...)  Failed to open: " + file_path;
       throw std::logic_error(message);
    }
-   m_files_written.insert(path);
    return path;
 }
 
 
-std::string  out_triangles::write_stl_binary(const std::string& file_path)
-{
-   boost::filesystem::path fullpath(file_path);
-   boost::filesystem::path stl_path = fullpath.parent_path() / fullpath.stem();
-   std::string path = stl_path.string() + ".stl";
-
-   // fix inconsistent slashes to something that is consistent and works everytwhere
-   std::replace(path.begin(),path.end(), '\\', '/');
+// a slice [begin,end> of the vertices or faces of a single lump
+struct binary_chunk {
+   size_t ilump, begin, end;
+};
 
-   if(FILE* stl = std::fopen(path.c_str(),"wb")) {
+// split the elements of all lumps into chunks of up to chunk_size, size_of returns the number of elements in a lump
+static size_t make_binary_chunks(const out_triangles::lump_vector& lumps, const std::function<size_t(const lump_mesh&)>& size_of, std::vector<binary_chunk>& chunks)
+{
+   const size_t chunk_size = 65536;
+   size_t nelem = 0;
+   for(size_t ilump=0; ilump<lumps.size(); ilump++) {
+      size_t n = size_of(*lumps[ilump]);
+      for(size_t begin=0; begin<n; begin+=chunk_size) {
+         chunks.push_back({ilump,begin,std::min(n,begin+chunk_size)});
+      }
+      nelem += n;
+   }
+   return nelem;
+}
 
-      // write the header
-      const size_t blen=80;
-      char buffer[blen];
-      for(size_t i=0; i<blen; i++) buffer[i]=' ';
-      std::fwrite(buffer,sizeof(char),blen,stl);
+// binary output file, "-" is standard output, which is only flushed on close.
+// A file that was not closed, e.g. because serialization threw, is closed and removed on destruction
+class binary_file {
+public:
+   binary_file(const std::string& path) : m_path(path), m_file(0)
+   {
+      if(path == "-") {
+#ifdef _MSC_VER
+         _setmode(_fileno(stdout),_O_BINARY);
+#endif
+         m_file = stdout;
+      }
+      else {
+         m_file = std::fopen(path.c_str(),"wb");
+      }
+   }
 
-      // write number of triangles
-      uint32_t ntri=0;
-      for(size_t ipoly=0; ipoly<m_polyset->size(); ipoly++) {
-         std::shared_ptr<carve::poly::Polyhedron> poly = (*m_polyset)[ipoly];
-         ntri += static_cast<uint32_t>(poly->faces.size());
+   ~binary_file()
+   {
+      if(m_file && m_file != stdout) {
+         std::fclose(m_file);
+         std::remove(m_path.c_str());
       }
-      std::fwrite(&ntri,sizeof(uint32_t),1,stl);
+   }
 
-      for(size_t ipoly=0; ipoly<m_polyset->size(); ipoly++) {
+   FILE* get() const { return m_file; }
 
-         std::shared_ptr<carve::poly::Polyhedron> poly = (*m_polyset)[ipoly];
-         std::vector<carve::poly::Geometry<3>::vertex_t>& vertices = poly->vertices;
+   // returns false on error
+   bool close()
+   {
+      FILE* file = m_file;
+      m_file = 0;
+      if(file == stdout) return (std::fflush(file) == 0);
+      return (std::fclose(file) == 0);
+   }
 
-         size_t nfaces = poly->faces.size();
-         for(size_t iface=0; iface < nfaces; iface++) {
+private:
+   binary_file(const binary_file&) = delete;
+   binary_file& operator=(const binary_file&) = delete;
 
-            size_t nv = poly->faces[iface].nVertices();
-            if(nv != 3)throw std::logic_error("out_triangles:: detected non-triangular face after triangulation!");
+   std::string m_path;
+   FILE*       m_file;
+};
 
-            typedef carve::geom::vector<3> vec3d;
-            std::vector<vec3d> p;
-            p.reserve(3);
-            std::vector<const carve::poly::Polyhedron::vertex_t *> vloop;
-            poly->faces[iface].getVertexLoop(vloop);
-            for(size_t ivert=0; ivert<nv; ivert++) {
-               size_t index = poly->vertexToIndex(vloop[ivert]);
-               carve::poly::Geometry<3>::vertex_t& vtx = vertices[index];
-               p.push_back(carve::geom::VECTOR(vtx.v[0],vtx.v[1],vtx.v[2]));
-            }
+// The chunks are serialized by record_size bytes per element, a batch of chunks at a time
+// on the thread pool, and written in order with one fwrite per chunk. Returns false on write error.
+static bool write_binary_chunks(FILE* file, const std::vector<binary_chunk>& chunks, size_t record_size, const std::function<void(const binary_chunk&,char*)>& serialize)
+{
+   bool ok = true;
+   size_t nthreads = std::max(1u,boost::thread::hardware_concurrency());
+   std::vector<std::vector<char>> buffers(nthreads);
+   for(size_t c_begin=0; ok && c_begin<chunks.size(); c_begin+=nthreads) {
+      size_t nbatch = std::min(nthreads,chunks.size()-c_begin);
+      run_concurrently(nbatch,[&chunks,&buffers,&serialize,c_begin,record_size](size_t ibatch) {
+         const binary_chunk& c = chunks[c_begin+ibatch];
+         std::vector<char>& buffer = buffers[ibatch];
+         buffer.resize((c.end-c.begin)*record_size);
+         serialize(c,buffer.data());
+      },nthreads);
+
+      for(size_t ibatch=0; ok && ibatch<nbatch; ibatch++) {
+         const std::vector<char>& buffer = buffers[ibatch];
+         ok = (std::fwrite(buffer.data(),1,buffer.size(),file) == buffer.size());
+      }
+   }
+   return ok;
+}
 
-            // compute facet normal
-            vec3d x = p[1] - p[0];
-            vec3d y = p[2] - p[0];
-            vec3d z = carve::geom::cross(x,y);
-            double len = sqrt(z[0]*z[0] + z[1]*z[1] + z[2]*z[2]);
+// serialize triangles [t_begin,t_end> of a lump as binary STL facets, 50 bytes each
+static void serialize_stl_facets(const lump_mesh& lump, size_t t_begin, size_t t_end, char* out)
+{
+   for(size_t iface=t_begin; iface < t_end; iface++) {
+
+      lump_mesh::face_ref face = lump.f_get(iface);
+      if(face.size() != 3)throw std::logic_error("out_triangles:: detected non-triangular face after triangulation!");
+
+      const xvertex& p0 = lump.v_get(face[0]);
+      const xvertex& p1 = lump.v_get(face[1]);
+      const xvertex& p2 = lump.v_get(face[2]);
+
+      // compute facet normal, zero for degenerate triangles
+      double ux = p1.x-p0.x, uy = p1.y-p0.y, uz = p1.z-p0.z;
+      double vx = p2.x-p0.x, vy = p2.y-p0.y, vz = p2.z-p0.z;
+      double nx = uy*vz - uz*vy;
+      double ny = uz*vx - ux*vz;
+      double nz = ux*vy - uy*vx;
+      double len = sqrt(nx*nx + ny*ny + nz*nz);
+      double scale = (len > 0)? 1.0/len : 0.0;
+
+      const float facet[12] = { static_cast<float>(nx*scale), static_cast<float>(ny*scale), static_cast<float>(nz*scale),
+                                static_cast<float>(p0.x), static_cast<float>(p0.y), static_cast<float>(p0.z),
+                                static_cast<float>(p1.x), static_cast<float>(p1.y), static_cast<float>(p1.z),
+                                static_cast<float>(p2.x), static_cast<float>(p2.y), static_cast<float>(p2.z) };
+      std::memcpy(out,facet,sizeof(facet));
+
+      // attribute byte count value
+      const uint16_t bcount = 0;
+      std::memcpy(out+sizeof(facet),&bcount,sizeof(bcount));
+      out += 50;
+   }
+}
 
-            // we write regardless of area here, because we didn't check the areas when we computed the number of triangles
-            float xyz[] = {static_cast<float>(z[0]/len), static_cast<float>(z[1]/len),  static_cast<float>(z[2]/len) };
-            std::fwrite(xyz,sizeof(float),3,stl);
+std::string  out_triangles::write_stl_binary(const std::string& file_path)
+{
+   boost::filesystem::path fullpath(file_path);
+   boost::filesystem::path stl_path = fullpath.parent_path() / fullpath.stem();
+   std::string path = (file_path == "-")? file_path : stl_path.string() + ".stl";
 
-            for(size_t iv=0;iv<nv;iv++) {
-               float xyz[] = {static_cast<float>(p[iv].x), static_cast<float>(p[iv].y),  static_cast<float>(p[iv].z) };
-               std::fwrite(xyz,sizeof(float),3,stl);
-            }
+   // fix inconsistent slashes to something that is consistent and works everytwhere
+   std::replace(path.begin(),path.end(), '\\', '/');
 
-            // write the attribute byte count value
-            uint16_t bcount = 0;
-            std::fwrite(&bcount, sizeof(bcount), 1, stl);
-         }
+   // The facets are serialized in chunks, each chunk is a slice of a single lump.
+   const size_t facet_size = 50;
+   std::vector<binary_chunk> chunks;
+   size_t ntri = make_binary_chunks(*m_lumps,[](const lump_mesh& lump) { return lump.f_size(); },chunks);
+   if(ntri > UINT32_MAX) throw std::logic_error("out_triangles::write_stl_binary(...) too many triangles for binary STL");
+
+   binary_file file(path);
+   if(FILE* stl = file.get()) {
+
+      // header and number of triangles
+      char header[84];
+      std::memset(header,' ',80);
+      uint32_t ntri32 = static_cast<uint32_t>(ntri);
+      std::memcpy(header+80,&ntri32,sizeof(ntri32));
+      bool ok = (std::fwrite(header,1,sizeof(header),stl) == sizeof(header));
+
+      ok = ok && write_binary_chunks(stl,chunks,facet_size,[this](const binary_chunk& c, char* out) {
+         serialize_stl_facets(*(*m_lumps)[c.ilump],c.begin,c.end,out);
+      });
+
+      if(!file.close()) ok = false;
+      if(!ok) {
+         std::string message = "out_triangles::write_stl_binary(...)  Failed to write: " + path;
+         throw std::logic_error(message);
       }
-
-      std::fclose(stl);
    }
    else {
       std::string message = "out_triangles::write_stl_binary(...)  Failed to open: " + file_path;
       throw std::logic_error(message);
    }
-   m_files_written.insert(path);
    return path;
 }
 
-std::set<std::string> out_triangles::copy_to(const std::string& dir_path)
+std::string  out_triangles::write_ply(const std::string& xcsg_path)
 {
-   namespace bfs = boost::filesystem;
+   boost::filesystem::path fullpath(xcsg_path);
+   boost::filesystem::path ply_path = fullpath.parent_path() / fullpath.stem();
+   std::string path = (xcsg_path == "-")? xcsg_path : ply_path.string() + ".ply";
 
-   std::string target_dir = dir_path;
+   // fix inconsistent slashes to something that is consistent and works everytwhere
+   std::replace(path.begin(),path.end(), '\\', '/');
 
-   // if the input path contains a file name, extract only the directory path
-   std_filename target_fname(target_dir);
-   if(target_fname.GetExt() != "") {
-      target_dir = target_fname.GetPath();
+   // all lumps share one vertex array, so face indices are offset by the vertices of the preceding lumps
+   std::vector<size_t> vertex_offset(m_lumps->size(),0);
+   for(size_t ilump=1; ilump<m_lumps->size(); ilump++) {
+      vertex_offset[ilump] = vertex_offset[ilump-1] + (*m_lumps)[ilump-1]->v_size();
    }
 
-   // make sure the target directory exists
-   if(!std_filename::Exists(target_dir)) {
-      std_filename::create_directories(target_dir);
+   std::vector<binary_chunk> v_chunks,f_chunks;
+   size_t nvert = make_binary_chunks(*m_lumps,[](const lump_mesh& lump) { return lump.v_size(); },v_chunks);
+   size_t nface = make_binary_chunks(*m_lumps,[](const lump_mesh& lump) { return lump.f_size(); },f_chunks);
+   if(nvert > INT32_MAX) throw std::logic_error("out_triangles::write_ply(...) too many vertices for binary PLY");
+   for(auto& lump : *m_lumps) {
+      if(!lump->triangles_only())throw std::logic_error("out_triangles:: detected non-triangular face after triangulation!");
    }
 
-   // traverse the files to be copied
-   std::set<std::string> files_copied;
-   for(auto& file : m_files_written) {
-      std_filename source_file(file);
-      std_filename target_file(file);
-      target_file.SetPath(target_dir);
-      bfs::copy_file(source_file.GetFullPath(),target_file.GetFullPath(),bfs::copy_option::overwrite_if_exists);
-
-      if(std_filename::Exists(target_file.GetFullPath())) {
-         std::string copied_path = target_file.GetFullPath();
-         std::replace(copied_path.begin(),copied_path.end(), '\\', '/');
-         files_copied.insert(copied_path);
+   binary_file file(path);
+   if(FILE* ply = file.get()) {
+
+      std::ostringstream header;
+      header << "ply\n"
+             << "format binary_little_endian 1.0\n"
+             << "comment xcsg\n"
+             << "element vertex " << nvert << '\n'
+             << "property float x\n"
+             << "property float y\n"
+             << "property float z\n"
+             << "element face " << nface << '\n'
+             << "property list uchar int vertex_indices\n"
+             << "end_header\n";
+      std::string hdr = header.str();
+      bool ok = (std::fwrite(hdr.data(),1,hdr.size(),ply) == hdr.size());
+
+      // vertex records are 3 floats
+      const size_t vertex_size = 12;
+      ok = ok && write_binary_chunks(ply,v_chunks,vertex_size,[this](const binary_chunk& c, char* out) {
+         const lump_mesh& lump = *(*m_lumps)[c.ilump];
+         for(size_t iv=c.begin; iv<c.end; iv++) {
+            const xvertex& p = lump.v_get(iv);
+            const float pos[3] = { static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z) };
+            std::memcpy(out,pos,sizeof(pos));
+            out += vertex_size;
+         }
+      });
+
+      // face records are a vertex count byte followed by 3 int indices
+      const size_t face_size = 13;
+      ok = ok && write_binary_chunks(ply,f_chunks,face_size,[this,&vertex_offset](const binary_chunk& c, char* out) {
+         const lump_mesh& lump = *(*m_lumps)[c.ilump];
+         const int32_t offset = static_cast<int32_t>(vertex_offset[c.ilump]);
+         for(size_t iface=c.begin; iface<c.end; iface++) {
+            lump_mesh::face_ref face = lump.f_get(iface);
+            const int32_t ind[3] = { offset + int32_t(face[0]), offset + int32_t(face[1]), offset + int32_t(face[2]) };
+            out[0] = 3;
+            std::memcpy(out+1,ind,sizeof(ind));
+            out += face_size;
+         }
+      });
+
+      if(!file.close()) ok = false;
+      if(!ok) {
+         std::string message = "out_triangles::write_ply(...)  Failed to write: " + path;
+         throw std::logic_error(message);
       }
    }
-
-   return std::move(files_copied);
+   else {
+      std::string message = "out_triangles::write_ply(...)  Failed to open: " + xcsg_path;
+      throw std::logic_error(message);
+   }
+   return path;
 }
@@ -17,20 +17,23 @@
 #define OUT_TRIANGLES_H
 
 #include <vector>
-#include <set>
 #include <memory>
-#include <carve/csg.hpp>
 #include <ostream>
+#include <string>
+class lump_mesh;
 
 class out_triangles {
 public:
-   typedef std::vector<std::shared_ptr<carve::poly::Polyhedron>> poly_vector;
+   typedef std::vector<std::shared_ptr<lump_mesh>> lump_vector;
 
-   out_triangles(std::shared_ptr<poly_vector> polyset);
+   // the lumps must be triangulated, except for OFF export.
+   // The write_* functions only read the lumps and may be called concurrently
+   out_triangles(std::shared_ptr<lump_vector> lumps);
    virtual ~out_triangles();
 
    // export to (formatted) STL, return the path to the file created
-   // input is full path to .xcsg file, stl to be stored in same folder
+   // input is full path to .xcsg file, stl to be stored in same folder.
+   // Binary STL is written to standard output when xcsg_path is "-"
    std::string  write_stl(const std::string& xcsg_path, bool binary);
 
    // export to OFF, return the path to the file created
@@ -44,11 +47,9 @@ public:
    // export to OpenSCAD .csg
    std::string  write_csg(const std::string& xcsg_path);
 
-   // add additional path to written files
-   void add_file_written(const std::string& file_path) { m_files_written.insert(file_path); }
-
-   // copy all previously written files to target directory, return set of target files copied
-   std::set<std::string> copy_to(const std::string& dir_path);
+   // export to binary little endian PLY with shared vertices, return the path to the file created
+   // input is full path to .xcsg file, PLY to be stored in same folder, "-" for standard output
+   std::string  write_ply(const std::string& xcsg_path);
 
 private:
    // write to ASCII STL, return the path to the file created
@@ -60,9 +61,7 @@ private:
    std::string  write_stl_binary(const std::string& file_path);
 
 private:
-   std::shared_ptr<poly_vector> m_polyset;
-
-   std::set<std::string> m_files_written;  // contains one entry per call to write_* functions
+   std::shared_ptr<lump_vector> m_lumps;
 };
 
 #endif // OUT_TRIANGLES_H
@@ -0,0 +1,231 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "perf_counters.h"
+#include "xcsg_status.h"
+#include <cstring>
+#include <iomanip>
+
+#ifdef __linux__
+   #include <linux/perf_event.h>
+   #include <sys/syscall.h>
+   #include <unistd.h>
+
+static int perf_event_open(uint32_t type, uint64_t config, bool inherit)
+{
+   struct perf_event_attr attr;
+   std::memset(&attr,0,sizeof(attr));
+   attr.size           = sizeof(attr);
+   attr.type           = type;
+   attr.config         = config;
+   attr.inherit        = (inherit)? 1 : 0;
+   attr.exclude_kernel = 1;  // user space only, allowed with perf_event_paranoid<=2
+   attr.exclude_hv     = 1;
+
+   // pid=0, cpu=-1: calling thread on any cpu
+   return static_cast<int>(syscall(__NR_perf_event_open,&attr,0,-1,-1,0));
+}
+#endif
+
+perf_values::perf_values()
+{
+   for(size_t ic=0; ic<NCOUNTERS; ic++) {
+      value[ic] = 0;
+      valid[ic] = false;
+   }
+}
+
+const char* perf_values::name(size_t ic)
+{
+   switch(ic) {
+      case CYCLES:       return "cycles";
+      case INSTRUCTIONS: return "instructions";
+      case CACHE_MISSES: return "cache_misses";
+      case PAGE_FAULTS:  return "page_faults";
+      default:           return "unknown";
+   };
+}
+
+void perf_values::add(const perf_values& other)
+{
+   for(size_t ic=0; ic<NCOUNTERS; ic++) {
+      value[ic] += other.value[ic];
+      valid[ic]  = valid[ic] && other.valid[ic];
+   }
+}
+
+perf_values perf_values::operator-(const perf_values& earlier) const
+{
+   perf_values diff;
+   for(size_t ic=0; ic<NCOUNTERS; ic++) {
+      diff.valid[ic] = valid[ic] && earlier.valid[ic];
+      diff.value[ic] = (diff.valid[ic] && value[ic]>earlier.value[ic])? value[ic]-earlier.value[ic] : 0;
+   }
+   return diff;
+}
+
+perf_counters::perf_counters(bool inherit)
+{
+   for(size_t ic=0; ic<perf_values::NCOUNTERS; ic++) m_fd[ic] = -1;
+
+#ifdef __linux__
+   m_fd[perf_values::CYCLES]       = perf_event_open(PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES,inherit);
+   m_fd[perf_values::INSTRUCTIONS] = perf_event_open(PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS,inherit);
+   m_fd[perf_values::CACHE_MISSES] = perf_event_open(PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES,inherit);
+   m_fd[perf_values::PAGE_FAULTS]  = perf_event_open(PERF_TYPE_SOFTWARE,PERF_COUNT_SW_PAGE_FAULTS,inherit);
+#else
+   (void)inherit;
+#endif
+}
+
+perf_counters::~perf_counters()
+{
+#ifdef __linux__
+   for(size_t ic=0; ic<perf_values::NCOUNTERS; ic++) {
+      if(m_fd[ic] >= 0) close(m_fd[ic]);
+   }
+#endif
+}
+
+bool perf_counters::available() const
+{
+   for(size_t ic=0; ic<perf_values::NCOUNTERS; ic++) {
+      if(m_fd[ic] >= 0) return true;
+   }
+   return false;
+}
+
+perf_values perf_counters::read() const
+{
+   perf_values values;
+#ifdef __linux__
+   for(size_t ic=0; ic<perf_values::NCOUNTERS; ic++) {
+      if(m_fd[ic] >= 0) {
+         uint64_t count = 0;
+         if(::read(m_fd[ic],&count,sizeof(count)) == sizeof(count)) {
+            values.value[ic] = count;
+            values.valid[ic] = true;
+         }
+      }
+   }
+#endif
+   return values;
+}
+
+perf_counters& perf_counters::thread_counters()
+{
+   thread_local perf_counters counters(false);
+   return counters;
+}
+
+perf_registry::perf_registry()
+: m_enabled(false)
+{}
+
+perf_registry::~perf_registry()
+{}
+
+void perf_registry::add(const std::string& scope, const perf_values& values)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   for(auto& s : m_scopes) {
+      if(s.name == scope) {
+         s.samples++;
+         s.values.add(values);
+         return;
+      }
+   }
+   // the first sample starts the accumulator, so its validity is kept as read
+   m_scopes.push_back(scope_values{scope,1,values});
+}
+
+void perf_registry::report(std::ostream& out)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   if(m_scopes.size() == 0) {
+      out << "...performance counters not available" << std::endl;
+      return;
+   }
+
+   out << "...performance counters (user space)" << std::endl;
+   out << "   " << std::left << std::setw(14) << "scope" << std::right << std::setw(8) << "samples";
+   for(size_t ic=0; ic<perf_values::NCOUNTERS; ic++) out << std::setw(16) << perf_values::name(ic);
+   out << std::setw(8) << "IPC" << std::endl;
+
+   for(auto& s : m_scopes) {
+      out << "   " << std::left << std::setw(14) << s.name << std::right << std::setw(8) << s.samples;
+      for(size_t ic=0; ic<perf_values::NCOUNTERS; ic++) {
+         if(s.values.valid[ic]) out << std::setw(16) << s.values.value[ic];
+         else                   out << std::setw(16) << "n/a";
+      }
+      const perf_values& v = s.values;
+      if(v.valid[perf_values::CYCLES] && v.valid[perf_values::INSTRUCTIONS] && v.value[perf_values::CYCLES]>0) {
+         double ipc = double(v.value[perf_values::INSTRUCTIONS])/double(v.value[perf_values::CYCLES]);
+         out << std::setw(8) << std::fixed << std::setprecision(2) << ipc << std::defaultfloat;
+      }
+      else {
+         out << std::setw(8) << "n/a";
+      }
+      out << std::endl;
+   }
+}
+
+void perf_registry::report_status()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   for(auto& s : m_scopes) {
+      std::vector<std::pair<std::string,long long>> counters;
+      for(size_t ic=0; ic<perf_values::NCOUNTERS; ic++) {
+         long long value = (s.values.valid[ic])? static_cast<long long>(s.values.value[ic]) : -1;
+         counters.push_back(std::make_pair(std::string(perf_values::name(ic)),value));
+      }
+      xcsg_status::singleton().perf(s.name,s.samples,counters);
+   }
+}
+
+perf_phases::perf_phases()
+: m_counters(0)
+{
+   if(perf_registry::singleton().enabled()) {
+      m_counters = new perf_counters(true);
+      if(!m_counters->available()) {
+         delete m_counters;
+         m_counters = 0;
+      }
+   }
+}
+
+perf_phases::~perf_phases()
+{
+   end();
+   delete m_counters;
+}
+
+void perf_phases::begin(const std::string& phase)
+{
+   end();
+   if(m_counters) {
+      m_phase = phase;
+      m_start = m_counters->read();
+   }
+}
+
+void perf_phases::end()
+{
+   if(m_counters && m_phase.length()>0) {
+      perf_registry::singleton().add(m_phase,m_counters->read() - m_start);
+      m_phase.clear();
+   }
+}
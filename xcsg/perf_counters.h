@@ -0,0 +1,127 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Hardware performance counters, using perf_event_open on Linux.
+// When counters are not available (other platforms, missing permissions,
+// virtual machines without a PMU), the values are simply marked invalid.
+
+// a set of counter values, or differences between two readings
+struct perf_values {
+   enum counter { CYCLES=0, INSTRUCTIONS, CACHE_MISSES, PAGE_FAULTS, NCOUNTERS };
+
+   perf_values();
+
+   // name of counter
+   static const char* name(size_t ic);
+
+   // accumulate values from another sample, a counter stays valid only if valid in both.
+   // Start accumulating from a copy of the first sample, not from a default perf_values
+   void add(const perf_values& other);
+
+   // this minus earlier reading
+   perf_values operator-(const perf_values& earlier) const;
+
+   uint64_t value[NCOUNTERS];
+   bool     valid[NCOUNTERS];
+};
+
+// perf_counters opens the counters for the calling thread. With inherit=true
+// threads created afterwards by the calling thread are included in the counts
+// once they have finished.
+class perf_counters {
+public:
+   perf_counters(bool inherit);
+   virtual ~perf_counters();
+
+   // true if at least one counter is available
+   bool available() const;
+
+   // read the current (cumulative) values
+   perf_values read() const;
+
+   // counters owned by the calling thread, opened on first use without inherit
+   static perf_counters& thread_counters();
+
+private:
+   perf_counters(const perf_counters&) = delete;
+   perf_counters& operator=(const perf_counters&) = delete;
+
+   int m_fd[perf_values::NCOUNTERS];
+};
+
+// perf_registry collects counter values per named scope,
+// e.g. per xcsg_main phase and for the sum of all carve booleans
+class perf_registry {
+public:
+   static perf_registry& singleton()  { static perf_registry instance; return instance;  }
+
+   // sampling is off unless enabled, so the cost is a flag test
+   void set_enabled(bool enabled) { m_enabled = enabled; }
+   bool enabled() const           { return m_enabled; }
+
+   // add a sample to a scope
+   void add(const std::string& scope, const perf_values& values);
+
+   // write a summary table
+   void report(std::ostream& out);
+
+   // write one status stream event per scope
+   void report_status();
+
+protected:
+   perf_registry();
+   virtual ~perf_registry();
+
+private:
+   struct scope_values {
+      std::string name;
+      size_t      samples;
+      perf_values values;
+   };
+
+   bool                      m_enabled;
+   std::mutex                m_mutex;
+   std::vector<scope_values> m_scopes;   // in order of first use
+};
+
+// perf_phases samples the whole process (calling thread + threads it creates)
+// for a sequence of phases. Nothing is done unless perf_registry is enabled.
+class perf_phases {
+public:
+   perf_phases();
+   virtual ~perf_phases();
+
+   // end the current phase (if any) and begin a new one
+   void begin(const std::string& phase);
+
+   // end the current phase
+   void end();
+
+private:
+   perf_counters* m_counters;
+   std::string    m_phase;
+   perf_values    m_start;
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,65 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef RUN_CONCURRENTLY_H
+#define RUN_CONCURRENTLY_H
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <list>
+#include <boost/thread.hpp>
+#include "safe_queue.h"
+
+// run task(i) for i in [0,n> on a pool of threads, tasks are picked in index order.
+// max_threads=0 means one thread per hardware thread. The first exception
+// thrown by a task is rethrown, with its original type, after all threads have finished.
+inline void run_concurrently(size_t n, const std::function<void(size_t)>& task, size_t max_threads = 0)
+{
+   if(n == 0) return;
+
+   size_t nthreads = (max_threads > 0)? max_threads : size_t(boost::thread::hardware_concurrency());
+   nthreads = std::max(size_t(1),std::min(nthreads,n));
+   if(nthreads == 1) {
+      for(size_t i=0; i<n; i++) task(i);
+      return;
+   }
+
+   safe_queue<size_t> work_queue;
+   for(size_t i=0; i<n; i++) work_queue.enqueue(i);
+
+   safe_queue<std::exception_ptr> exception_queue;
+   std::list<boost::thread> threads;
+   for(size_t ithread=0; ithread<nthreads; ithread++) {
+      threads.push_back(boost::thread([&task,&work_queue,&exception_queue]() {
+         try {
+            size_t i = 0;
+            while(work_queue.try_dequeue(i)) task(i);
+         }
+         catch(...) {
+            exception_queue.enqueue(std::current_exception());
+         }
+      }));
+   }
+
+   // wait for the threads to finish
+   for(auto& t : threads) t.join();
+
+   if(exception_queue.size() > 0) {
+      std::rethrow_exception(exception_queue.dequeue());
+   }
+}
+
+#endif // RUN_CONCURRENTLY_H
@@ -0,0 +1,103 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "text_buffer.h"
+#include "run_concurrently.h"
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+text_buffer::text_buffer()
+: m_buf(4096)
+, m_size(0)
+{}
+
+text_buffer::~text_buffer()
+{}
+
+text_buffer& text_buffer::put(double value)
+{
+   const size_t maxlen = 32;
+   char* first = reserve(maxlen);
+   std::to_chars_result res = std::to_chars(first,first+maxlen,value);
+   if(res.ec != std::errc()) throw std::logic_error("text_buffer: number formatting failed");
+   m_size += res.ptr - first;
+   return *this;
+}
+
+text_buffer& text_buffer::put(double value, int precision)
+{
+   const size_t maxlen = 32;
+   char* first = reserve(maxlen);
+   std::to_chars_result res = std::to_chars(first,first+maxlen,value,std::chars_format::general,precision);
+   if(res.ec != std::errc()) throw std::logic_error("text_buffer: number formatting failed");
+   m_size += res.ptr - first;
+   return *this;
+}
+
+text_buffer& text_buffer::put(uint64_t value)
+{
+   const size_t maxlen = 24;
+   char* first = reserve(maxlen);
+   std::to_chars_result res = std::to_chars(first,first+maxlen,value);
+   m_size += res.ptr - first;
+   return *this;
+}
+
+text_buffer& text_buffer::put(char c)
+{
+   *reserve(1) = c;
+   m_size++;
+   return *this;
+}
+
+text_buffer& text_buffer::put(const char* s)
+{
+   size_t len = std::strlen(s);
+   std::memcpy(reserve(len),s,len);
+   m_size += len;
+   return *this;
+}
+
+text_buffer& text_buffer::put(const std::string& s)
+{
+   std::memcpy(reserve(s.length()),s.data(),s.length());
+   m_size += s.length();
+   return *this;
+}
+
+void text_buffer::write_blocks(std::ostream& out, size_t n, size_t block_size,
+                               const std::function<void(size_t,size_t,text_buffer&)>& format)
+{
+   // a batch of blocks is formatted concurrently, one buffer per thread, then written in order.
+   // The buffers are reused for the next batch
+   size_t nthreads = std::max(size_t(1),size_t(boost::thread::hardware_concurrency()));
+   std::vector<text_buffer> buffers(nthreads);
+   size_t nblock = (n + block_size - 1)/block_size;
+   for(size_t b_begin=0; b_begin<nblock; b_begin+=nthreads) {
+      size_t nbatch = std::min(nthreads,nblock-b_begin);
+      run_concurrently(nbatch,[&buffers,&format,b_begin,block_size,n](size_t ibatch) {
+         size_t begin = (b_begin+ibatch)*block_size;
+         size_t end   = std::min(n,begin+block_size);
+         text_buffer& buffer = buffers[ibatch];
+         buffer.clear();
+         format(begin,end,buffer);
+      },nthreads);
+
+      for(size_t ibatch=0; ibatch<nbatch; ibatch++) {
+         out.write(buffers[ibatch].data(),buffers[ibatch].size());
+      }
+   }
+}
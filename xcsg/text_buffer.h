@@ -0,0 +1,67 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// text_buffer is an append only character buffer for the text exporters.
+// Numbers are formatted with std::to_chars, doubles in shortest round trip form.
+
+class text_buffer {
+public:
+   text_buffer();
+   virtual ~text_buffer();
+
+   void        clear()       { m_size = 0; }
+   size_t      size() const  { return m_size; }
+   const char* data() const  { return m_buf.data(); }
+
+   // shortest representation that reads back to the same value
+   text_buffer& put(double value);
+
+   // printf %g style with given number of significant digits
+   text_buffer& put(double value, int precision);
+
+   text_buffer& put(uint64_t value);
+   text_buffer& put(char c);
+   text_buffer& put(const char* s);
+   text_buffer& put(const std::string& s);
+
+   // format items [0,n> in blocks of block_size on the thread pool and write the
+   // blocks to out in order. format(begin,end,buffer) appends items [begin,end> to buffer.
+   static void write_blocks(std::ostream& out, size_t n, size_t block_size,
+                            const std::function<void(size_t,size_t,text_buffer&)>& format);
+
+private:
+   // make room for at least n more characters
+   char* reserve(size_t n)
+   {
+      if(m_size+n > m_buf.size()) m_buf.resize(std::max(2*m_buf.size(),m_size+n));
+      return m_buf.data()+m_size;
+   }
+
+private:
+   std::vector<char> m_buf;
+   size_t            m_size;
+};
+
+#endif // TEXT_BUFFER_H
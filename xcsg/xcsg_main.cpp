@@ -18,6 +18,10 @@
 #include <boost/date_time.hpp>
 
 #include <sstream>
+#include <list>
+#include <functional>
+#include <boost/thread.hpp>
+#include <boost/thread/scoped_thread.hpp>
 #include <stdexcept>
 using namespace std;
 #include "csg_parser/cf_xmlTree.h"
@@ -26,11 +30,18 @@ using namespace std;
 
 #include "clipper_boolean.h"
 #include "carve_boolean.h"
-#include "carve_triangulate.h"
 #include "mesh_utils.h"
 #include "xpolyhedron.h"
 #include "xcsg_factory.h"
 #include "boolean_timer.h"
+#include "xcsg_status.h"
+#include "cancel_token.h"
+#include "perf_counters.h"
+#include "mesh_stats.h"
+#include "mesh_validator.h"
+#include "lump_mesh.h"
+#include "carve_mesh_thread.h"
+#include "run_concurrently.h"
 
 #include "openscad_csg.h"
 #include "out_triangles.h"
@@ -73,32 +84,81 @@ bool xcsg_main::run()
       throw std::logic_error(sout.str());
    }
 
-   if(!std_filename::Exists(xcsg_file)) throw std::runtime_error("File does not exist: " + xcsg_file);
+   if(!m_cmd.stdin_input() && !std_filename::Exists(xcsg_file)) throw std::runtime_error("File does not exist: " + xcsg_file);
 
    // determine if we shall display full file paths
    bool show_path = m_cmd.count("fullpath")>0;
 
    cf_xmlTree tree;
+   tree.set_compact(m_cmd.count("compact_xcsg")>0);
    std_filename file(xcsg_file);
 
-   if(file.GetExt() == ".csg") {
+   // the .xcsg converted from .csg input is written in the background, joined on exit
+   std::string xcsg_writer_path;
+   std::string xcsg_writer_error;
+   boost::scoped_thread<> xcsg_writer;
+
+   xcsg_status::singleton().phase("parse");
+   bool tree_ok = false;
+   if(m_cmd.stdin_input()) {
+
+      // the format is given by the first character, xml, JSON or else OpenSCAD csg
+      cin >> std::ws;
+      int first = cin.peek();
+      if(first == '<')      tree_ok = tree.read_xcsg(cin);
+      else if(first == '{') tree_ok = tree.read_xcsg_json(cin);
+      else {
+         csg_parser parser(cin,m_cmd.secant_tolerance());
+         parser.to_xcsg(tree);
+         tree_ok = true;
+      }
+   }
+   else if(file.GetExt() == ".csg") {
 
       cout << "Converting from: " << DisplayName(xcsg_file,show_path) << endl;
-      std::ifstream csg(xcsg_file);
-      csg_parser parser(csg,m_cmd.secant_tolerance());
+      csg_parser parser(xcsg_file,m_cmd.secant_tolerance());
       parser.to_xcsg(tree);
 
+      // the converted tree is used directly
       file.SetExt("xcsg");
       xcsg_file = file.GetFullPath();
-      tree.write_xml(xcsg_file);
+      tree_ok   = true;
+
+      if(m_cmd.count("no_xcsg")==0 || m_cmd.count("xcsg")>0) {
+         // this is the only writer of the converted .xcsg, --xcsg places it as the other output files
+         xcsg_writer_path = (m_cmd.count("xcsg")>0)? output_base(xcsg_file) : xcsg_file;
+
+         // the tree is only read while the model is computed, so it can be written concurrently
+         xcsg_writer = boost::scoped_thread<>(boost::thread([&tree,&xcsg_writer_error,xcsg_writer_path]() {
+            try {
+               if(!tree.write_xml(xcsg_writer_path)) xcsg_writer_error = "could not write " + xcsg_writer_path;
+            }
+            catch(std::exception& ex) {
+               xcsg_writer_error = ex.what();
+            }
+         }));
+      }
    }
+   else if(file.GetExt() == ".json") {
 
-   if(tree.read_xml(xcsg_file)) {
+      // .xcsg.json, output files are named as for the .xcsg
+      tree_ok   = tree.read_xcsg_json(xcsg_file);
+      xcsg_file = xcsg_file.substr(0,xcsg_file.size()-5);
+   }
+   else {
+      tree_ok = (file.GetExt() == ".xcsgb")? tree.read_binary(xcsg_file) : tree.read_xcsg(xcsg_file);
+   }
+
+   if(tree_ok) {
 
       cout << "xcsg processing: " << DisplayName(file,show_path) << endl;
 
+      // conversions between .xcsg and .xcsgb are written from the tree directly
+      write_conversions(tree,xcsg_file,file.GetFullPath(),xcsg_writer.joinable(),show_path);
+      bool geometry = (m_cmd.count("xcsg") + m_cmd.count("xcsgb")) < m_cmd.out_count();
+
       cf_xmlNode root;
-      if(tree.get_root(root)) {
+      if(geometry && tree.get_root(root)) {
          if("xcsg" == root.tag()) {
 
             // set the global secant tolerance,
@@ -125,12 +185,157 @@ bool xcsg_main::run()
    else {
       cout << "error: xcsg input file not found: " << xcsg_file << endl;
    }
+
+   if(xcsg_writer.joinable()) {
+      xcsg_writer.join();
+      if(xcsg_writer_error.length() > 0) throw std::runtime_error("xcsg file not written: " + xcsg_writer_error);
+      report_output("xcsg","Created XCSG file    : ",xcsg_writer_path,show_path);
+   }
    return true;
 }
 
 
+// result of checking and triangulating a single lump
+struct lump_check {
+   lump_check() : num_faces(0), num_non_tri(0), num_tri(0), num_dropped(0), tri_sec(0) {}
+   size_t      num_faces;    // polygon faces before triangulation
+   std::string check_text;   // console output from mesh_validator
+   size_t      num_non_tri;
+   lump_stats  stats;
+   size_t      num_tri;      // triangles after triangulation, 0 if not triangulated
+   size_t      num_dropped;  // zero area triangles dropped during triangulation
+   double      tri_sec;      // seconds spent triangulating this lump
+};
+
+// check lumps concurrently, results are stored per lump so they can be reported in order
+static void check_lumps(std::vector<std::shared_ptr<lump_mesh>>& lumps, bool compute_stats, std::vector<lump_check>& checks)
+{
+   checks.resize(lumps.size());
+   run_concurrently(lumps.size(),[&lumps,&checks,compute_stats](size_t ilump) {
+      std::ostringstream out;
+      mesh_check check = mesh_validator::check(*lumps[ilump]);
+      check.report(out);
+      checks[ilump].num_faces   = lumps[ilump]->f_size();
+      checks[ilump].num_non_tri = check.num_non_tri;
+      checks[ilump].check_text = out.str();
+      if(compute_stats) checks[ilump].stats = mesh_stats::compute(*lumps[ilump]);
+   });
+}
+
+// triangulate lumps with non-triangular faces concurrently. The hardware threads are
+// shared between the lumps, each lump triangulates its faces on its share.
+static void triangulate_lumps(std::vector<std::shared_ptr<lump_mesh>>& lumps, std::vector<lump_check>& checks)
+{
+   std::vector<size_t> todo;
+   for(size_t ilump=0; ilump<lumps.size(); ilump++) {
+      if(checks[ilump].num_non_tri > 0) todo.push_back(ilump);
+   }
+   if(todo.size() == 0) return;
+
+   size_t nthreads = std::max(size_t(1),size_t(boost::thread::hardware_concurrency()));
+   size_t nthreads_lump = std::max(size_t(1),nthreads/todo.size());
+   cancel_token& cancel = cancel_token::singleton();
+   run_concurrently(todo.size(),[&lumps,&checks,&todo,&cancel,nthreads_lump](size_t itodo) {
+      if(cancel.cancelled()) return;
+      size_t ilump      = todo[itodo];
+      bool improve      = true;
+      bool degen_check  = true;
+      boost::posix_time::ptime time_0 = boost::posix_time::microsec_clock::universal_time();
+      checks[ilump].num_tri = lumps[ilump]->triangulate(improve,degen_check,checks[ilump].num_dropped,nthreads_lump);
+      checks[ilump].tri_sec = 0.001*(boost::posix_time::microsec_clock::universal_time() - time_0).total_milliseconds();
+   },nthreads);
+   cancel.check();
+}
+
+void xcsg_main::write_conversions(cf_xmlTree& tree, const std::string& xcsg_file, const std::string& input_file, bool xcsg_in_background, bool show_path)
+{
+   std_filename input(input_file);
+   std_filename file(output_base(xcsg_file));
+
+   if(m_cmd.count("xcsgb")>0) {
+      file.SetExt("xcsgb");
+      if(file.GetFullPath() != input.GetFullPath()) {
+         tree.write_binary(file.GetFullPath());
+         report_output("xcsgb","Created XCSGB file   : ",file.GetFullPath(),show_path);
+      }
+   }
+
+   if(m_cmd.count("xcsg")>0 && !xcsg_in_background) {
+      file.SetExt("xcsg");
+      if(file.GetFullPath() != input.GetFullPath()) {
+         tree.write_xml(file.GetFullPath());
+         report_output("xcsg","Created XCSG file    : ",file.GetFullPath(),show_path);
+      }
+   }
+}
+
+void xcsg_main::report_output(const std::string& format, const std::string& label, const std::string& path, bool show_path)
+{
+   cout << label << DisplayName(std_filename(path),show_path) << endl;
+   xcsg_status::singleton().output(format,path);
+}
+
+std::string xcsg_main::output_base(const std::string& xcsg_file)
+{
+   auto export_pair = m_cmd.export_dir();
+   if(!export_pair.first) return xcsg_file;
+
+   // if the export path contains a file name, use only the directory path
+   std::string target_dir = export_pair.second;
+   std_filename target_fname(target_dir);
+   if(target_fname.GetExt() != "") {
+      target_dir = target_fname.GetPath();
+   }
+
+   // make sure the target directory exists
+   if(!std_filename::Exists(target_dir)) {
+      std_filename::create_directories(target_dir);
+   }
+
+   std_filename file(xcsg_file);
+   file.SetPath(target_dir);
+   return file.GetFullPath();
+}
+
+void xcsg_main::write_partial(const std::string& xcsg_file, bool show_path)
+{
+   // the partial results are the meshes completed so far, not yet combined.
+   // They may overlap and are exported as separate lumps for diagnosis only
+   std::vector<cancel_token::MeshSet_ptr> partial = cancel_token::singleton().partial();
+   if(partial.size() == 0) {
+      cout << "...no partial results available" << endl;
+      return;
+   }
+
+   auto lumps = std::make_shared<out_triangles::lump_vector>();
+   for(auto& mesh : partial) {
+      carve_boolean csg;
+      csg.compute(mesh,carve::csg::CSG::OP::UNION);
+      std::vector<std::shared_ptr<lump_mesh>> mesh_lumps;
+      csg.create_lumps(mesh_lumps);
+      for(auto& lump : mesh_lumps) {
+         bool improve      = false;
+         bool degen_check  = true;
+         size_t num_dropped = 0;
+         lump->triangulate(improve,degen_check,num_dropped);
+         lumps->push_back(lump);
+      }
+   }
+
+   // with input from standard input, the partial file is written to the current directory
+   std_filename file(output_base(m_cmd.stdin_input()? "stdin.xcsg" : xcsg_file));
+   file.SetName(file.GetName() + "_partial");
+   out_triangles exporter(lumps);
+   report_output("partial","Created partial STL  : ",exporter.write_stl(file.GetFullPath(),true),show_path);
+}
+
 bool xcsg_main::run_xsolid(cf_xmlNode& node,const std::string& xcsg_file)
 {
+   xcsg_status& status = xcsg_status::singleton();
+   status.phase("tree");
+   perf_phases perf;
+   perf.begin("tree");
+
    cout << "processing solid: " << node.tag() << endl;
    std::shared_ptr<xsolid> obj = xcsg_factory::singleton().make_solid(node);
    if(obj.get()) {
@@ -150,85 +355,134 @@ bool xcsg_main::run_xsolid(cf_xmlNode& node,const std::string& xcsg_file)
       if(nbool > 0) {
          cout << "...starting boolean operations" << endl;
       }
+      status.phase("boolean");
+      perf.begin("boolean");
 
       boost::posix_time::ptime time_0 = boost::posix_time::microsec_clock::universal_time();
       carve_boolean csg;
       try {
 
          boolean_timer::singleton().init(static_cast<int>(nbool));
-         csg.compute(obj->create_carve_mesh(),carve::csg::CSG::OP::UNION);
+         std::shared_ptr<carve::mesh::MeshSet<3>> mesh = obj->create_carve_mesh();
+         carve_mesh_thread::record_source(*obj,mesh);
+         csg.compute(mesh,carve::csg::CSG::OP::UNION);
+         mesh.reset();
          boost::posix_time::time_duration  ptime_diff = boost::posix_time::microsec_clock::universal_time() - time_0;
          double elapsed_sec = 0.001*ptime_diff.total_milliseconds();
 
          cout << "...completed boolean operations in " << setprecision(5) << elapsed_sec << " [sec] " << endl;
       }
+      catch(cancel_exception& ex) {
+
+         // write what was completed before giving up, if requested
+         cout << "...boolean operations aborted: " << ex.what() << endl;
+         if(m_cmd.partial()) write_partial(xcsg_file,show_path);
+         throw;
+      }
       catch(carve::exception& ex ) {
 
          // rethrow as std::exception
          string msg("(carve error): ");
          msg += ex.str();
          cout << "WARNING: " << msg << endl;
+         status.warning(msg);
 //         throw std::exception(msg.c_str());
       }
 
       size_t nmani = csg.size();
       cout << "...result model contains " << nmani << ((nmani==1)? " lump.": " lumps.") << endl;
+      status.lumps(nmani);
 
-      // we export only triangles
-       boost::posix_time::ptime time_1 = boost::posix_time::microsec_clock::universal_time();
-      carve_triangulate triangulate;
-      for(size_t imani=0; imani<nmani; imani++) {
+      bool show_stats = m_cmd.count("stats")>0;
+      if(show_stats) {
+         mesh_source_stats::singleton().report(cout);
+         mesh_source_stats::singleton().report_status();
+      }
 
-         // create & check lump
-         std::shared_ptr<xpolyhedron> poly = csg.create_manifold(imani);
-         cout << "...lump " << imani+1 << ": " <<poly->v_size() << " vertices, " << poly->f_size() << " polygon faces." << endl;
+      status.phase("triangulate");
+      perf.begin("triangulate");
 
-         size_t num_non_tri = 0;
-         poly->check_polyhedron(cout,num_non_tri);
+      // create lumps directly from the boolean result, then check and triangulate them concurrently.
+      // we export only triangles
+      auto lumps = std::make_shared<out_triangles::lump_vector>();
+      csg.create_lumps(*lumps);
+      csg.clear();
+      std::vector<lump_check> checks;
+      check_lumps(*lumps,show_stats,checks);
+      triangulate_lumps(*lumps,checks);
+
+      // report the lumps in order
+      for(size_t imani=0; imani<nmani; imani++) {
 
-         if(num_non_tri > 0) {
-            cout << "...Triangulating lump ... " << std::endl;
-            bool improve      = true;
-            bool canonicalize = true;
-            bool degen_check  = true;
+         cancel_token::singleton().check();
 
-            cout << "...Triangulation completed with " << triangulate.compute(poly->create_carve_polyhedron(),improve,canonicalize,degen_check)<< " triangle faces ";
-//            cout << "...Triangulation completed with " << triangulate.compute2d(poly->create_carve_polyhedron())<< " triangle faces ";
+         // report lump check
+         std::shared_ptr<lump_mesh> lump = (*lumps)[imani];
+         cout << "...lump " << imani+1 << ": " <<lump->v_size() << " vertices, " << checks[imani].num_faces << " polygon faces." << endl;
+         status.lump(imani,lump->v_size(),checks[imani].num_faces);
 
-            boost::posix_time::ptime time_2 = boost::posix_time::microsec_clock::universal_time();
-            double elapsed_2 = 0.001*(time_2 - time_1).total_milliseconds();
-            cout << "in " << elapsed_2 << " [sec]" << endl;
+         size_t num_non_tri = checks[imani].num_non_tri;
+         cout << checks[imani].check_text;
 
+         if(show_stats) {
+            const lump_stats& stats = checks[imani].stats;
+            cout << "...lump " << imani+1 << " stats: "
+                 << stats.degenerate << " degenerate, " << stats.sliver << " sliver faces, edge length ["
+                 << stats.min_edge << ", " << stats.max_edge << "], "
+                 << stats.dup_clusters << " near duplicate vertex clusters (" << stats.dup_vertices << " vertices)" << endl;
+            status.lump_stats(imani,stats.degenerate,stats.sliver,stats.min_edge,stats.max_edge,stats.dup_clusters,stats.dup_vertices);
          }
-         else {
-            // triangulation not required
-            triangulate.add(poly->create_carve_polyhedron());
+
+         if(num_non_tri > 0) {
+            cout << "...Triangulating lump ... " << std::endl;
+            size_t num_dropped = checks[imani].num_dropped;
+            if(num_dropped>0) cout << ">>> Warning: dropped "<<num_dropped <<" zero area triangles(s) during triangulation." << std::endl;
+            cout << "...Triangulation completed with " << checks[imani].num_tri << " triangle faces ";
+            cout << "in " << checks[imani].tri_sec << " [sec]" << endl;
          }
       }
       cout <<    "...Exporting results " << endl;
-
-      // create object for file export
-      out_triangles exporter(triangulate.carve_polyset());
-
-      if(m_cmd.count("csg")>0)       cout << "Created OpenSCAD file: " << DisplayName(std_filename(exporter.write_csg(xcsg_file)),show_path) << endl;
-      if(m_cmd.count("amf")>0) {
-         amf_file amf;
-         std::string amf_path = amf.write(triangulate.carve_polyset(),xcsg_file);
-         cout << "Created AMF file     : " << DisplayName(std_filename(amf_path),show_path) << endl;
-         exporter.add_file_written(amf_path);
+      status.phase("export");
+      perf.begin("export");
+
+      // output files are written directly to the export directory, if given
+      std::string out_file = m_cmd.stdout_output()? "-" : output_base(xcsg_file);
+
+      // the requested formats are written concurrently from the shared lumps,
+      // which are not modified during export
+      out_triangles exporter(lumps);
+      struct export_task {
+         std::string format;
+         std::string label;
+         std::function<std::string()> write;
+         std::string path;
+      };
+      std::vector<export_task> tasks;
+      std::vector<export_task> stl_tasks;
+      if(m_cmd.count("csg")>0)       tasks.push_back({"csg", "Created OpenSCAD file: ",[&exporter,&out_file]() { return exporter.write_csg(out_file); },""});
+      if(m_cmd.count("amf")>0 || m_cmd.count("amf_zip")>0) {
+         bool compress = m_cmd.count("amf_zip")>0;
+         tasks.push_back({"amf", "Created AMF file     : ",[&lumps,&out_file,compress]() { amf_file amf; return amf.write(lumps,out_file,compress); },""});
       }
-      if(m_cmd.count("obj")>0)       cout << "Created OBJ file     : " << DisplayName(std_filename(exporter.write_obj(xcsg_file)),show_path) << endl;
-      if(m_cmd.count("off")>0)       cout << "Created OFF file(s)  : " << DisplayName(std_filename(exporter.write_off(xcsg_file)),show_path) << endl;
-      // write STL last so it is the most recent updated format
-      if(m_cmd.count("stl")>0)       cout << "Created STL file     : " << DisplayName(std_filename(exporter.write_stl(xcsg_file,true)),show_path) << endl;
-      else if(m_cmd.count("astl")>0) cout << "Created STL file     : " << DisplayName(std_filename(exporter.write_stl(xcsg_file,false)),show_path) << endl;
-
-      // check if export is requested
-      auto export_pair = m_cmd.export_dir();
-      if(export_pair.first) {
-         auto files_copied = exporter.copy_to(export_pair.second);
-         for(auto& f : files_copied) cout << "Exported to          : " << f << endl;
+      if(m_cmd.count("obj")>0)       tasks.push_back({"obj", "Created OBJ file     : ",[&exporter,&out_file]() { return exporter.write_obj(out_file); },""});
+      if(m_cmd.count("off")>0)       tasks.push_back({"off", "Created OFF file(s)  : ",[&exporter,&out_file]() { return exporter.write_off(out_file); },""});
+      if(m_cmd.count("ply")>0)       tasks.push_back({"ply", "Created PLY file     : ",[&exporter,&out_file]() { return exporter.write_ply(out_file); },""});
+      if(m_cmd.count("stl")>0)       stl_tasks.push_back({"stl", "Created STL file     : ",[&exporter,&out_file]() { return exporter.write_stl(out_file,true); },""});
+      else if(m_cmd.count("astl")>0) stl_tasks.push_back({"astl","Created STL file     : ",[&exporter,&out_file]() { return exporter.write_stl(out_file,false); },""});
+
+      run_concurrently(tasks.size(),[&tasks](size_t itask) { tasks[itask].path = tasks[itask].write(); });
+
+      // STL shall be the most recent updated format, so it is written after the other formats are complete
+      for(auto& task : stl_tasks) {
+         task.path = task.write();
+         tasks.push_back(task);
       }
+
+      for(auto& task : tasks) {
+         report_output(task.format,task.label,task.path,show_path);
+      }
+
+      perf.end();
    }
    else {
       throw logic_error("xcsg tree contains no data. ");
@@ -239,7 +493,16 @@ bool xcsg_main::run_xsolid(cf_xmlNode& node,const std::string& xcsg_file)
 
 bool xcsg_main::run_xshape2d(cf_xmlNode& node,const std::string& xcsg_file)
 {
+   xcsg_status& status = xcsg_status::singleton();
+   status.phase("tree");
+   perf_phases perf;
+   perf.begin("tree");
+
    cout << "processing shape2d: " << node.tag() << endl;
+
+   // --stl and --ply are 3d formats, so a 2d model has nothing to write to standard output
+   if(m_cmd.stdout_output()) throw std::logic_error("2d model " + node.tag() + " cannot be written to standard output, only --stl and --ply 3d models can");
+
    std::shared_ptr<xshape2d> obj = xcsg_factory::singleton().make_shape2d(node);
    if(obj.get()) {
 
@@ -257,47 +520,46 @@ bool xcsg_main::run_xshape2d(cf_xmlNode& node,const std::string& xcsg_file)
       if(nbool > 0) {
          cout << "...starting boolean operations" << endl;
       }
+      status.phase("boolean");
+      perf.begin("boolean");
       clipper_boolean csg;
       csg.compute(obj->create_clipper_profile(),ClipperLib::ctUnion);
 
       std::shared_ptr<polyset2d> polyset = csg.profile()->polyset();
       size_t nmani = polyset->size();
       cout << "...result model contains " << nmani << ((nmani==1)? " lump.": " lumps.") << endl;
+      status.lumps(nmani);
+      status.phase("export");
+      perf.begin("export");
+
+      // output files are written directly to the export directory, if given
+      std::string out_file = output_base(xcsg_file);
 
       if(m_cmd.count("csg")>0) {
-         openscad_csg openscad(xcsg_file);
+         openscad_csg openscad(out_file);
          size_t imani = 0;
          for(auto i=polyset->begin(); i!=polyset->end(); i++) {
             std::shared_ptr<polygon2d> poly = *i;
             openscad.write_polygon(poly);
          }
-         cout << "Created OpenSCAD file: " << DisplayName(std_filename(openscad.path()),show_path) << endl;
+         report_output("csg","Created OpenSCAD file: ",openscad.path(),show_path);
       }
 
-      out_triangles exporter(nullptr);
-
       // write SVG?
       if(m_cmd.count("svg")>0) {
          svg_file svg;
-         std::string svg_path = svg.write(polyset,xcsg_file);
-         exporter.add_file_written(svg_path);
-         cout << "Created SVG      file: " << DisplayName(std_filename(svg_path),show_path) << endl;
+         std::string svg_path = svg.write(polyset,out_file);
+         report_output("svg","Created SVG      file: ",svg_path,show_path);
       }
 
       // write DXF last so it is the most recent updated format
       if(m_cmd.count("dxf")>0) {
          dxf_file dxf;
-         std::string dxf_path = dxf.write(polyset,xcsg_file);
-         exporter.add_file_written(dxf_path);
-         cout << "Created DXF      file: " << DisplayName(std_filename(dxf_path),show_path) << endl;
+         std::string dxf_path = dxf.write(polyset,out_file);
+         report_output("dxf","Created DXF      file: ",dxf_path,show_path);
       }
 
-      // check if export is requested
-      auto export_pair = m_cmd.export_dir();
-      if(export_pair.first) {
-         auto files_copied = exporter.copy_to(export_pair.second);
-         for(auto& f : files_copied) cout << "Exported to          : " << f << endl;
-      }
+      perf.end();
    }
    else {
       throw logic_error("xcsg tree contains no data. ");
@@ -18,6 +18,7 @@
 
 #include "boost_command_line.h"
 class cf_xmlNode;
+class cf_xmlTree;
 
 class xcsg_main {
 public:
@@ -31,6 +32,20 @@ protected:
    bool run_xsolid(cf_xmlNode& node,const std::string& xcsg_file);
    bool run_xshape2d(cf_xmlNode& node,const std::string& xcsg_file);
 
+   // write the tree as .xcsgb and/or .xcsg, when requested and different from the input file.
+   // The .xcsg is skipped when it is already being written in the background
+   void write_conversions(cf_xmlTree& tree, const std::string& xcsg_file, const std::string& input_file, bool xcsg_in_background, bool show_path);
+
+   // report a written file on the console and to the status stream
+   void report_output(const std::string& format, const std::string& label, const std::string& path, bool show_path);
+
+   // write partial results after processing was aborted, as <name>_partial.stl
+   void write_partial(const std::string& xcsg_file, bool show_path);
+
+   // return the path that output file names are derived from: the input file itself,
+   // or the same file name in the export directory, which is created if required
+   std::string output_base(const std::string& xcsg_file);
+
 private:
    boost_command_line m_cmd;
 };
@@ -0,0 +1,157 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "xcsg_status.h"
+
+#ifdef _MSC_VER
+   #include <io.h>
+   #define xcsg_fdopen _fdopen
+#else
+   #include <stdio.h>
+   #define xcsg_fdopen fdopen
+#endif
+
+xcsg_status::xcsg_status()
+: m_out(0)
+, m_time0(std::chrono::steady_clock::now())
+{}
+
+xcsg_status::~xcsg_status()
+{
+   if(m_out && m_out!=stdout && m_out!=stderr) std::fclose(m_out);
+}
+
+bool xcsg_status::open(int fd)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   if(m_out) return false;
+
+   if(fd == 1)      m_out = stdout;
+   else if(fd == 2) m_out = stderr;
+   else if(fd > 2)  m_out = xcsg_fdopen(fd,"w");
+
+   m_time0 = std::chrono::steady_clock::now();
+   return (m_out != 0);
+}
+
+std::string xcsg_status::quote(const std::string& s)
+{
+   std::string q;
+   q.reserve(s.size()+2);
+   q += '"';
+   for(char c : s) {
+      switch(c) {
+         case '"':  { q += "\\\""; break; }
+         case '\\': { q += "\\\\"; break; }
+         case '\n': { q += "\\n";  break; }
+         case '\r': { q += "\\r";  break; }
+         case '\t': { q += "\\t";  break; }
+         default: {
+            if(static_cast<unsigned char>(c) < 0x20) {
+               char buf[8];
+               std::snprintf(buf,sizeof(buf),"\\u%04x",static_cast<unsigned int>(c));
+               q += buf;
+            }
+            else q += c;
+         }
+      };
+   }
+   q += '"';
+   return q;
+}
+
+void xcsg_status::emit(const char* event, const std::string& fields)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   if(!m_out) return;
+
+   double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_time0).count();
+   std::fprintf(m_out,"{\"event\":\"%s\",\"t\":%.3f%s%s}\n",event,t,(fields.size()>0)? ",":"",fields.c_str());
+   std::fflush(m_out);
+}
+
+void xcsg_status::phase(const std::string& name)
+{
+   if(!m_out) return;
+   emit("phase","\"phase\":"+quote(name));
+}
+
+void xcsg_status::progress(unsigned int nbool, unsigned int nbool_tot, double elapsed_sec, double eta_sec)
+{
+   if(!m_out) return;
+
+   double percent = (nbool_tot>0)? (100.0*nbool)/nbool_tot : 0.0;
+   char buf[160];
+   if(eta_sec < 0) std::snprintf(buf,sizeof(buf),"\"nbool\":%u,\"nbool_tot\":%u,\"percent\":%.1f,\"elapsed_sec\":%.3f,\"eta_sec\":null",nbool,nbool_tot,percent,elapsed_sec);
+   else            std::snprintf(buf,sizeof(buf),"\"nbool\":%u,\"nbool_tot\":%u,\"percent\":%.1f,\"elapsed_sec\":%.3f,\"eta_sec\":%.3f",nbool,nbool_tot,percent,elapsed_sec,eta_sec);
+   emit("progress",buf);
+}
+
+void xcsg_status::lumps(size_t nlumps)
+{
+   if(!m_out) return;
+   emit("lumps","\"count\":"+std::to_string(nlumps));
+}
+
+void xcsg_status::lump(size_t ilump, size_t nvert, size_t nface)
+{
+   if(!m_out) return;
+   emit("lump","\"index\":"+std::to_string(ilump)+",\"vertices\":"+std::to_string(nvert)+",\"faces\":"+std::to_string(nface));
+}
+
+void xcsg_status::lump_stats(size_t ilump, size_t degenerate, size_t sliver, double min_edge, double max_edge, size_t dup_clusters, size_t dup_vertices)
+{
+   if(!m_out) return;
+   char buf[256];
+   std::snprintf(buf,sizeof(buf),"\"index\":%zu,\"degenerate\":%zu,\"sliver\":%zu,\"min_edge\":%.9g,\"max_edge\":%.9g,\"dup_clusters\":%zu,\"dup_vertices\":%zu",
+                 ilump,degenerate,sliver,min_edge,max_edge,dup_clusters,dup_vertices);
+   emit("lump_stats",buf);
+}
+
+void xcsg_status::source(const std::string& type, size_t count, size_t faces, size_t max_faces)
+{
+   if(!m_out) return;
+   emit("source","\"type\":"+quote(type)+",\"count\":"+std::to_string(count)+",\"faces\":"+std::to_string(faces)+",\"max_faces\":"+std::to_string(max_faces));
+}
+
+void xcsg_status::output(const std::string& format, const std::string& path)
+{
+   if(!m_out) return;
+   emit("output","\"format\":"+quote(format)+",\"path\":"+quote(path));
+}
+
+void xcsg_status::perf(const std::string& scope, size_t samples, const std::vector<std::pair<std::string,long long>>& counters)
+{
+   if(!m_out) return;
+   std::string fields = "\"scope\":"+quote(scope)+",\"samples\":"+std::to_string(samples);
+   for(auto& c : counters) {
+      fields += ","+quote(c.first)+":"+((c.second<0)? std::string("null") : std::to_string(c.second));
+   }
+   emit("perf",fields);
+}
+
+void xcsg_status::warning(const std::string& text)
+{
+   if(!m_out) return;
+   emit("warning","\"text\":"+quote(text));
+}
+
+void xcsg_status::finished(const std::string& status, const std::string& text, double elapsed_sec)
+{
+   if(!m_out) return;
+   char buf[64];
+   std::snprintf(buf,sizeof(buf),",\"elapsed_sec\":%.3f",elapsed_sec);
+   emit("finished","\"status\":"+quote(status)+",\"text\":"+quote(text)+buf);
+}
@@ -0,0 +1,90 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef XCSG_STATUS_H
+#define XCSG_STATUS_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+
+// xcsg_status emits a machine readable status stream for job orchestration.
+// Each event is written as a single line JSON object (newline delimited JSON)
+// and flushed immediately. Nothing is written unless the stream has been opened,
+// so the cost is a single pointer test per event in normal runs.
+//
+// Every event contains "event" and "t" (seconds since the stream was opened), e.g.
+//   {"event":"phase","t":0.012,"phase":"boolean"}
+//   {"event":"progress","t":3.2,"nbool":35,"nbool_tot":100,"percent":35.0,"eta_sec":5.9}
+
+class xcsg_status {
+public:
+   static xcsg_status& singleton()  { static xcsg_status instance; return instance;  }
+
+   // open the status stream on a file descriptor (1=stdout, 2=stderr, etc.)
+   bool open(int fd);
+
+   // true if status events are written
+   bool is_open() const { return m_out != 0; }
+
+   // phase transition: "parse", "tree", "boolean", "triangulate", "export"
+   void phase(const std::string& name);
+
+   // boolean progress, eta_sec<0 means the remaining time is unknown
+   void progress(unsigned int nbool, unsigned int nbool_tot, double elapsed_sec, double eta_sec);
+
+   // number of lumps in result model
+   void lumps(size_t nlumps);
+
+   // statistics for a single lump (ilump is zero based)
+   void lump(size_t ilump, size_t nvert, size_t nface);
+
+   // quality metrics for a single lump, see mesh_stats
+   void lump_stats(size_t ilump, size_t degenerate, size_t sliver, double min_edge, double max_edge, size_t dup_clusters, size_t dup_vertices);
+
+   // faces in primitive meshes of a given type entering the booleans
+   void source(const std::string& type, size_t count, size_t faces, size_t max_faces);
+
+   // a file was written in the given format
+   void output(const std::string& format, const std::string& path);
+
+   // performance counter totals for a scope, negative values are unavailable counters
+   void perf(const std::string& scope, size_t samples, const std::vector<std::pair<std::string,long long>>& counters);
+
+   // warnings and other messages of interest
+   void warning(const std::string& text);
+
+   // final event, status is "ok" or "error"
+   void finished(const std::string& status, const std::string& text, double elapsed_sec);
+
+protected:
+   xcsg_status();
+   virtual ~xcsg_status();
+
+   // write one complete event, "fields" are additional comma separated json members
+   void emit(const char* event, const std::string& fields);
+
+   // return string as quoted and escaped JSON string
+   static std::string quote(const std::string& s);
+
+private:
+   std::FILE*                             m_out;
+   std::mutex                             m_mutex;
+   std::chrono::steady_clock::time_point  m_time0;
+};
+
+#endif // XCSG_STATUS_H
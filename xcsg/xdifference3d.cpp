@@ -14,6 +14,7 @@
 // EndLicense:
 
 #include <numeric>
+#include <algorithm>
 
 #include "xdifference3d.h"
 #include "carve_boolean.h"
@@ -22,6 +23,7 @@
 #include "xsolid_collector.h"
 
 #include "carve_boolean_thread.h"
+#include "cancel_token.h"
 #include "carve_mesh_thread.h"
 
 xdifference3d::xdifference3d( )
@@ -47,6 +49,8 @@ std::shared_ptr<carve::mesh::MeshSet<3>> xdifference3d::compute_union(const carv
       ithread->join();
    }
 
+   cancel_token::singleton().check(mesh_queue);
+
    if(exception_queue.size() > 0) {
       throw std::logic_error(exception_queue.dequeue());
    }
@@ -56,12 +60,40 @@ std::shared_ptr<carve::mesh::MeshSet<3>> xdifference3d::compute_union(const carv
 }
 
 
+std::unordered_set<std::shared_ptr<xsolid>> xdifference3d::cull_excluded(const carve::math::Matrix& t, std::shared_ptr<carve::mesh::MeshSet<3>> a) const
+{
+   if(!a.get() || a->vertex_storage.size() == 0) return m_excl;
+
+   // box of the included mesh
+   xvertex amin = a->vertex_storage[0].v;
+   xvertex amax = amin;
+   for(auto& vertex : a->vertex_storage) {
+      for(size_t k=0; k<3; k++) {
+         amin.v[k] = std::min(amin.v[k],vertex.v.v[k]);
+         amax.v[k] = std::max(amax.v[k],vertex.v.v[k]);
+      }
+   }
+
+   // objects with a known box not overlapping it cannot remove anything, their meshes are never created
+   std::unordered_set<std::shared_ptr<xsolid>> excl;
+   carve::math::Matrix tt = t*get_transform();
+   for(auto& obj : m_excl) {
+      xvertex bmin,bmax;
+      bool disjoint = obj->bounding_box(tt,bmin,bmax);
+      for(size_t k=0; disjoint && k<3; k++) {
+         disjoint = (bmax.v[k] < amin.v[k] || bmin.v[k] > amax.v[k]);
+      }
+      if(!disjoint) excl.insert(obj);
+   }
+   return excl;
+}
+
 std::shared_ptr<carve::mesh::MeshSet<3>> xdifference3d::create_carve_mesh(const carve::math::Matrix& t) const
 {
    // run booleans in threads
 
    std::shared_ptr<carve::mesh::MeshSet<3>>  a = compute_union(t,m_incl);
-   std::shared_ptr<carve::mesh::MeshSet<3>>  b = compute_union(t,m_excl);
+   std::shared_ptr<carve::mesh::MeshSet<3>>  b = compute_union(t,cull_excluded(t,a));
 
    carve_boolean csg;
    csg.compute(a,carve::csg::CSG::UNION);
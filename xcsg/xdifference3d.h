@@ -32,6 +32,9 @@ public:
 private:
    std::shared_ptr<carve::mesh::MeshSet<3>> compute_union(const carve::math::Matrix& t, std::unordered_set<std::shared_ptr<xsolid>>  objects) const;
 
+   // the excluded objects that may overlap the included mesh a
+   std::unordered_set<std::shared_ptr<xsolid>> cull_excluded(const carve::math::Matrix& t, std::shared_ptr<carve::mesh::MeshSet<3>> a) const;
+
 private:
    std::unordered_set<std::shared_ptr<xsolid>> m_incl;
    std::unordered_set<std::shared_ptr<xsolid>> m_excl;
@@ -14,30 +14,20 @@
 // EndLicense:
 
 #include "xface.h"
-#include <map>
 
 xface::xface(cf_xmlNode& face)
 {
-   std::map<size_t,size_t> v;
-   int max_id=-1;
    for(auto i=face.begin(); i!=face.end(); i++) {
       cf_xmlNode fv(i);
       if(!fv.is_attribute_node()) {
          if("fv" == fv.tag()) {
-            size_t id = v.size();
-            v[id] = fv.get_property("index",-1);
+            m_indices.push_back(fv.get_property("index",-1));
          }
          else {
             throw logic_error("face: expected 'fv' but found " + fv.tag());
          }
       }
    }
-
-   // copy to member variable
-   m_indices.resize(v.size());
-   for(auto i=v.begin(); i!=v.end(); i++) {
-      m_indices[i->first] = i->second;
-   }
 }
 
 xface xface::reverse_copy() const
@@ -39,6 +39,7 @@ public:
 
    // polygon face (possibly more than 4 vertices)
    xface(const std::vector<size_t>& indices) : m_indices(indices) {}
+   xface(std::vector<size_t>&& indices) : m_indices(std::move(indices)) {}
    virtual ~xface() {}
 
    // number of vertices in face
@@ -20,6 +20,7 @@
 #include "xsolid_collector.h"
 
 #include "carve_boolean_thread.h"
+#include "cancel_token.h"
 #include "carve_mesh_thread.h"
 
 xintersection3d::xintersection3d()
@@ -57,6 +58,8 @@ std::shared_ptr<carve::mesh::MeshSet<3>> xintersection3d::create_carve_mesh(cons
       ithread->join();
    }
 
+   cancel_token::singleton().check(mesh_queue);
+
    if(exception_queue.size() > 0) {
       throw std::logic_error(exception_queue.dequeue());
    }
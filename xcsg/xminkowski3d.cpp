@@ -4,6 +4,7 @@
 
 #include "carve_boolean.h"
 #include "carve_boolean_thread.h"
+#include "cancel_token.h"
 #include "carve_minkowski_thread.h"
 
 #include "boolean_timer.h"
@@ -58,6 +59,9 @@ std::shared_ptr<carve::mesh::MeshSet<3>> xminkowski3d::create_carve_mesh(const c
    for(auto ithread=csg_threads.begin(); ithread!=csg_threads.end(); ithread++) {
       ithread->join();
    }
+
+   cancel_token::singleton().check(mesh_queue);
+
    if(exception_queue.size() > 0) {
       throw std::logic_error(exception_queue.dequeue());
    }
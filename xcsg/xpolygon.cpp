@@ -17,6 +17,7 @@
 #include "primitives2d.h"
 #include "primitives3d.h"
 #include "csg_parser/cf_xmlNode.h"
+#include "csg_parser/cf_xmlPayload.h"
 #include <map>
 
 xpolygon::xpolygon()
@@ -29,7 +30,15 @@ xpolygon::xpolygon(const cf_xmlNode& node)
    set_transform(node);
 
    cf_xmlNode vertices;
-   if(node.get_child("vertices",vertices)) {
+   std::shared_ptr<const cf_xmlPayload> payload;
+   if(node.get_child("vertices",vertices) && (payload = vertices.payload())) {
+      cf_xmlArray<double> c = payload->values();
+      m_vert.resize(c.size()/3);
+      for(size_t iv=0; iv<m_vert.size(); iv++) {
+         m_vert[iv] = carve::geom::VECTOR(c[3*iv],c[3*iv+1],0.0);
+      }
+   }
+   else if(node.get_child("vertices",vertices)) {
 
        // be sure to sort the vertices
        std::map<size_t,xvertex> v;
@@ -19,57 +19,10 @@
 #include "qhull/qhull3d.h"
 #include "carve_boolean.h"
 #include "csg_parser/cf_xmlNode.h"
+#include "csg_parser/cf_xmlPayload.h"
 #include "mesh_utils.h"
-#include <map>
-
-/*
-static double face_area(const std::vector<xvertex>& p)
-{
-   // https://en.wikipedia.org/wiki/Heron's_formula
-   double a = (p[1] - p[0]).length();
-   double b = (p[2] - p[1]).length();
-   double c = (p[0] - p[2]).length();
-   double s = 0.5*(a+b+c);
-   return sqrt(s*(s-a)*(s-b)*(s-c));
-}
-*/
-
-static double face_area(const std::vector<xvertex>& p)
-{
-   double area = 0.0;
-
-   typedef carve::geom::vector<3> vec3d;
-   if(p.size() == 3) {
-
-      // triangle
-      vec3d x = p[1] - p[0];
-      vec3d y = p[2] - p[0];
-      vec3d normal = carve::geom::cross(x,y);
-      area = 0.5*normal.length();
-   }
-   else {
-
-      // general polygon
-      vec3d normal = carve::geom::VECTOR(0.0,0.0,0.0);
-      size_t n = p.size();
-      vec3d b  = p[n-2];
-      vec3d c  = p[n-1];
-      for(size_t i=0; i<n; i++ ) {
-
-         vec3d a = b;
-         b       = c;
-         c       = p[i];
-
-         double dx = b.y * (c.z - a.z);
-         double dy = b.z * (c.x - a.x);
-         double dz = b.x * (c.y - a.y);
-
-         normal += carve::geom::VECTOR(dx,dy,dz);
-      }
-      area = 0.5*normal.length();
-   }
-   return area;
-}
+#include "mesh_validator.h"
+#include <iterator>
 
 xpolyhedron::xpolyhedron()
 {}
@@ -80,6 +33,8 @@ xpolyhedron::~xpolyhedron()
 xpolyhedron::xpolyhedron(const xpolyhedron& other)
 : m_vertices(other.m_vertices)
 , m_faces(other.m_faces)
+, m_v_payload(other.m_v_payload)
+, m_f_payload(other.m_f_payload)
 {}
 
 xpolyhedron::xpolyhedron(const cf_xmlNode& const_node)
@@ -93,53 +48,41 @@ xpolyhedron::xpolyhedron(const cf_xmlNode& const_node)
 
        cf_xmlNode sub(i);
        if(!sub.is_attribute_node()) {
-          if("vertices" == sub.tag()) {
-
-             // be sure to sort the vertices
-             map<size_t,xvertex> v;
+          auto payload = sub.payload();
+          if("vertices" == sub.tag() && payload) {
+             m_v_payload = payload;
+          }
+          else if("faces" == sub.tag() && payload) {
+             m_f_payload = payload;
+          }
+          else if("vertices" == sub.tag()) {
              for(auto iv=sub.begin(); iv!=sub.end(); iv++) {
 
                 // get next vertex
                 cf_xmlNode vertex(iv);
                 if("vertex" == vertex.tag()) {
-                   size_t id = v.size();
-                   v[id]= carve::geom::VECTOR( vertex.get_property("x",0.0),
-                                               vertex.get_property("y",0.0),
-                                               vertex.get_property("z",0.0));
+                   m_vertices.push_back(carve::geom::VECTOR( vertex.get_property("x",0.0),
+                                                             vertex.get_property("y",0.0),
+                                                             vertex.get_property("z",0.0)));
                 }
                 else {
                    throw logic_error("polyhedron: expected tag 'vertex' but found " + vertex.tag());
                 }
              }
-
-             // copy to member variable
-             m_vertices.resize(v.size());
-             for(auto i=v.begin(); i!=v.end(); i++) {
-                m_vertices[i->first] = i->second;
-             }
           }
           else if("faces" == sub.tag()) {
-
-             map<int,xface> f;
-             int id = -1;
              for(auto iv=sub.begin(); iv!=sub.end(); iv++) {
                 // get next face
                 cf_xmlNode face(iv);
                 if(!face.is_attribute_node()) {
                    if("face" == face.tag()) {
-                      f[++id] = xface(face);
+                      m_faces.push_back(xface(face));
                    }
                    else {
                       throw logic_error("polyhedron: expected tag 'face' but found " + face.tag());
                    }
                 }
              }
-
-             // copy to member variable
-             m_faces.resize(f.size());
-             for(auto i=f.begin(); i!=f.end(); i++) {
-                m_faces[i->first] = i->second;
-             }
           }
           else if("tmatrix" == sub.tag()) {
              // skip this, already handled via set_transform(...)
@@ -151,6 +94,50 @@ xpolyhedron::xpolyhedron(const cf_xmlNode& const_node)
     }
 }
 
+void xpolyhedron::decode() const
+{
+   if(!lazy()) return;
+
+   std::call_once(m_decoded,[this]() {
+      if(m_v_payload) {
+         cf_xmlArray<double> c = m_v_payload->values();
+         m_vertices.resize(c.size()/3);
+         for(size_t iv=0; iv<m_vertices.size(); iv++) {
+            m_vertices[iv] = carve::geom::VECTOR(c[3*iv],c[3*iv+1],c[3*iv+2]);
+         }
+      }
+      if(m_f_payload) {
+         m_faces.resize(m_f_payload->f_size());
+         std::vector<size_t> indices;
+         for(size_t iface=0; iface<m_faces.size(); iface++) {
+            m_f_payload->f_get(iface,indices);
+            m_faces[iface] = xface(indices);
+         }
+      }
+   });
+}
+
+void xpolyhedron::modify()
+{
+   // after this, m_vertices and m_faces are the only data
+   decode();
+   m_v_payload.reset();
+   m_f_payload.reset();
+}
+
+bool xpolyhedron::bounding_box(const carve::math::Matrix& t, xvertex& pmin, xvertex& pmax) const
+{
+   if(m_v_payload) {
+      cf_xmlArray<double> c = m_v_payload->values();
+      return vertex_box(t,c.data(),c.size()/3,pmin,pmax);
+   }
+
+   std::vector<double> xyz;
+   xyz.reserve(3*m_vertices.size());
+   for(auto& v : m_vertices) xyz.insert(xyz.end(),{v.x,v.y,v.z});
+   return vertex_box(t,xyz.data(),m_vertices.size(),pmin,pmax);
+}
+
 std::shared_ptr<carve::mesh::MeshSet<3>> xpolyhedron::create_carve_mesh(const carve::math::Matrix& t) const
 {
    bool reverse_face = mesh_utils::is_left_hand(t);
@@ -158,6 +145,32 @@ std::shared_ptr<carve::mesh::MeshSet<3>> xpolyhedron::create_carve_mesh(const ca
    carve::input::PolyhedronData data;
    carve::input::Options options;
 
+   if(m_v_payload && m_f_payload && m_f_payload->f_size() > 0) {
+
+      // directly from the payloads, without decoding to m_vertices and m_faces.
+      // With only one of them a payload, both are decoded below
+      carve::math::Matrix tt = t*get_transform();
+      cf_xmlArray<double> c = m_v_payload->values();
+      size_t nvert = c.size()/3;
+      data.reserveVertices(static_cast<int>(nvert));
+      for(size_t iv=0; iv<nvert; iv++) {
+         data.addVertex(tt*carve::geom::VECTOR(c[3*iv],c[3*iv+1],c[3*iv+2]));
+      }
+
+      cf_xmlArray<uint32_t> rows = m_f_payload->face_row();
+      cf_xmlArray<uint32_t> ind  = m_f_payload->face_ind();
+      size_t nface = m_f_payload->f_size();
+      data.reserveFaces(static_cast<int>(nface),4);
+      for(size_t iface=0; iface<nface; iface++) {
+         const uint32_t* fbegin = ind.data()+rows[iface];
+         const uint32_t* fend   = ind.data()+rows[iface+1];
+         if(reverse_face) data.addFace(std::reverse_iterator<const uint32_t*>(fend),std::reverse_iterator<const uint32_t*>(fbegin));
+         else             data.addFace(fbegin,fend);
+      }
+      return std::shared_ptr<carve::mesh::MeshSet<3>>(data.createMesh(options));
+   }
+
+   decode();
    if(m_faces.size() > 0) {
 
       // conventional polyhedron
@@ -193,11 +206,13 @@ std::shared_ptr<carve::mesh::MeshSet<3>> xpolyhedron::create_carve_mesh(const ca
 
 void xpolyhedron::v_reserve(size_t nverts)
 {
+   modify();
    m_vertices.reserve(nverts);
 }
 
 size_t xpolyhedron::v_add(const xvertex& pos)
 {
+   modify();
    size_t index = m_vertices.size();
    m_vertices.push_back(pos);
    return index;
@@ -205,96 +220,63 @@ size_t xpolyhedron::v_add(const xvertex& pos)
 
 size_t xpolyhedron::v_size() const
 {
+   decode();
    return m_vertices.size();
 }
 
 const xvertex& xpolyhedron::v_get(size_t v_ind) const
 {
+   decode();
    return m_vertices.at(v_ind);
 }
 
 void xpolyhedron::f_reserve(size_t nfaces)
 {
+   modify();
    m_faces.reserve(nfaces);
 }
 
 size_t xpolyhedron::f_add(const xface& face, bool reverse_face)
 {
+   modify();
    size_t index = m_faces.size();
    if(reverse_face) m_faces.push_back(face.reverse_copy());
    else             m_faces.push_back(face);
    return index;
 }
 
+size_t xpolyhedron::f_add(xface&& face)
+{
+   modify();
+   size_t index = m_faces.size();
+   m_faces.push_back(std::move(face));
+   return index;
+}
+
 size_t xpolyhedron::f_size() const
 {
+   decode();
    return m_faces.size();
 }
 
 const xface& xpolyhedron::f_get(size_t f_ind) const
 {
+   decode();
    return m_faces.at(f_ind);
 }
 
 bool  xpolyhedron::check_polyhedron(ostream& out, size_t& num_non_tri)
 {
-   map<size_t,size_t> edge_count;
-   size_t face_error=0;
-
-   num_non_tri = 0;
-
-   for(auto i=m_faces.begin(); i!=m_faces.end(); i++) {
-      const xface& face = *i;
-
-      std::vector<xvertex> p;
-      p.reserve(face.size());
-      for(size_t i=0; i<face.size(); i++) {
-         p.push_back(m_vertices[face[i]]);
-      }
-      if(!(face_area(p)>0.0))face_error++;
-
-      num_non_tri += (face.size()!=3)? 1 : 0;
-
-      // number of edges == number of vertices
-      size_t nedge = face.size();
-      size_t last_edge = nedge-1;
-      for(size_t iedge=0; iedge<nedge; iedge++) {
-         size_t iv0 = face[iedge];
-         size_t iv1 = (iedge<last_edge)? face[iedge+1] : face[0];
-         size_t edge_id = std::min(iv0,iv1)*1000000 + std::max(iv0,iv1);
-         edge_count[edge_id]++;
-      }
-   }
-
-   size_t nerr = 0;
-   size_t nc1  = 0;
-   for(auto i=edge_count.begin(); i!=edge_count.end(); i++) {
-      if(i->second != 2) {
-         nerr++;
-         if(i->second == 1)nc1++;
-      }
-   }
-
-   if(nerr == 0) {
-      out << "...Polyhedron is water-tight (edge use-count check OK)" << endl;
-   }
-   else {
-      out << ">>> Warning: Polyhedron is not water-tight, it has " << edge_count.size() << " edges, " << nerr << " with wrong use count, " << nc1 << " with use-count==1" << endl;
-   }
-   if(face_error == 0) {
-      out << "...Polyhedron has no degenerated faces (face area check OK)" << endl;
-   }
-   else {
-      out << ">>> Warning: Polyhedron has " << face_error << " zero area faces." << endl;
-   }
-
-   out << "...Polyhedron has "<< num_non_tri << " non-triangular faces" << endl;
-   return ((face_error+nerr)==0);
+   mesh_check check = mesh_validator::check(*this);
+   check.report(out);
+   num_non_tri = check.num_non_tri;
+   return check.ok();
 }
 
 
 std::shared_ptr<carve::poly::Polyhedron> xpolyhedron::create_carve_polyhedron()
 {
+   decode();
    carve::input::PolyhedronData data;
    data.points = m_vertices;
    data.reserveFaces(static_cast<int>(m_faces.size()),4);
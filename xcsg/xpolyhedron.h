@@ -17,8 +17,10 @@
 #define XPOLYHEDRON_H
 
 #include <vector>
+#include <mutex>
 #include "xface.h"
 #include "xsolid.h"
+class cf_xmlPayload;
 
 class xpolyhedron : public xsolid {
 public:
@@ -36,6 +38,7 @@ public:
    // faces
    void           f_reserve(size_t nfaces);
    size_t         f_add(const xface& face, bool reverse_face);
+   size_t         f_add(xface&& face);
    size_t         f_size() const;
    const xface&   f_get(size_t f_ind) const;
 
@@ -44,11 +47,25 @@ public:
    // create meshset from this polyhedron
    std::shared_ptr<carve::mesh::MeshSet<3>> create_carve_mesh(const carve::math::Matrix& t = carve::math::Matrix()) const;
 
+   // box of the vertices, computed from the payload when not decoded
+   bool bounding_box(const carve::math::Matrix& t, xvertex& pmin, xvertex& pmax) const;
+
    std::shared_ptr<carve::poly::Polyhedron> create_carve_polyhedron();
 
 private:
-   std::vector<xvertex> m_vertices;  // vertex coordinates
-   std::vector<xface>   m_faces;     // vertex indices for faces
+   // polyhedrons read with payloads keep them as they are until the vertex or face
+   // accessors are used. create_carve_mesh reads the payloads directly.
+   bool lazy() const { return m_v_payload || m_f_payload; }
+   void decode() const;
+   void modify();
+
+private:
+   mutable std::vector<xvertex> m_vertices;  // vertex coordinates
+   mutable std::vector<xface>   m_faces;     // vertex indices for faces
+   mutable std::once_flag       m_decoded;
+
+   std::shared_ptr<const cf_xmlPayload> m_v_payload;  // undecoded <vertices>
+   std::shared_ptr<const cf_xmlPayload> m_f_payload;  // undecoded <faces>
 };
 
 #endif // XPOLYHEDRON_H
@@ -18,6 +18,7 @@
 #include "xsolid_collector.h"
 
 #include "carve_boolean_thread.h"
+#include "cancel_token.h"
 #include "carve_mesh_thread.h"
 #include "project_mesh.h"
 
@@ -66,6 +67,8 @@ std::shared_ptr<clipper_profile> xprojection2d ::create_clipper_profile(const ca
       ithread->join();
    }
 
+   cancel_token::singleton().check(mesh_queue);
+
    if(exception_queue.size() > 0) {
       throw std::logic_error(exception_queue.dequeue());
    }
@@ -16,6 +16,7 @@
 #include "xsolid.h"
 #include "csg_parser/cf_xmlNode.h"
 #include "xtmatrix.h"
+#include <algorithm>
 
 xsolid::xsolid()
 {}
@@ -38,3 +39,35 @@ const carve::math::Matrix& xsolid::get_transform() const
    return m_t;
 }
 
+bool xsolid::bounding_box(const carve::math::Matrix& , xvertex& , xvertex& ) const
+{
+   return false;
+}
+
+bool xsolid::vertex_box(const carve::math::Matrix& t, const double* xyz, size_t nvert, xvertex& pmin, xvertex& pmax) const
+{
+   if(nvert == 0) return false;
+
+   // box in local coordinates
+   xvertex lmin = carve::geom::VECTOR(xyz[0],xyz[1],xyz[2]);
+   xvertex lmax = lmin;
+   for(size_t iv=1; iv<nvert; iv++) {
+      const double* p = xyz+3*iv;
+      for(size_t k=0; k<3; k++) {
+         lmin.v[k] = std::min(lmin.v[k],p[k]);
+         lmax.v[k] = std::max(lmax.v[k],p[k]);
+      }
+   }
+
+   // the transformed corners enclose the transformed vertices
+   carve::math::Matrix tt = t*get_transform();
+   for(size_t ic=0; ic<8; ic++) {
+      xvertex corner = tt*carve::geom::VECTOR((ic&1)? lmax.x : lmin.x, (ic&2)? lmax.y : lmin.y, (ic&4)? lmax.z : lmin.z);
+      if(ic == 0) pmin = pmax = corner;
+      for(size_t k=0; k<3; k++) {
+         pmin.v[k] = std::min(pmin.v[k],corner.v[k]);
+         pmax.v[k] = std::max(pmax.v[k],corner.v[k]);
+      }
+   }
+   return true;
+}
@@ -31,6 +31,14 @@ public:
 
    virtual std::shared_ptr<carve::mesh::MeshSet<3>> create_carve_mesh(const carve::math::Matrix& t = carve::math::Matrix()) const = 0;
 
+   // axis aligned box enclosing the mesh create_carve_mesh(t) would return, without creating it.
+   // Returns false when the box is not known in advance
+   virtual bool bounding_box(const carve::math::Matrix& t, xvertex& pmin, xvertex& pmax) const;
+
+protected:
+   // box of the vertices given as x,y,z triplets, transformed by t*get_transform()
+   bool vertex_box(const carve::math::Matrix& t, const double* xyz, size_t nvert, xvertex& pmin, xvertex& pmax) const;
+
 private:
    carve::math::Matrix m_t;
 };
@@ -15,56 +15,59 @@
 
 #include "xsolid_collector.h"
 #include "xcsg_factory.h"
+#include "run_concurrently.h"
+#include <vector>
 
-void xsolid_collector::collect_children(const cf_xmlNode& parent, ShapeSet& A)
+// true in threads constructing sibling subtrees, their own children are constructed serially
+static thread_local bool s_in_parallel_build = false;
+
+// construct the solid children of parent in document order. Siblings are constructed as
+// parallel tasks when there are enough of them, each task writes only its own result slot
+static void make_solids(const cf_xmlNode& parent, std::vector<std::shared_ptr<xsolid>>& solids)
 {
-   size_t icount=0;
+   std::vector<cf_xmlNode> nodes;
    cf_xmlNode tmp(parent);
    for(auto i=tmp.begin(); i!=tmp.end(); i++) {
       cf_xmlNode sub(i);
-      if(xcsg_factory::singleton().is_solid(sub)) {
-         A.insert(xcsg_factory::singleton().make_solid(sub));
-         icount++;
-      }
+      if(xcsg_factory::singleton().is_solid(sub)) nodes.push_back(sub);
    }
-   if(icount == 0) {
+   if(nodes.size() == 0) {
       throw logic_error("Expected solids under " + parent.tag() + ", but found none.");
    }
+
+   solids.resize(nodes.size());
+   size_t nthreads = std::max(size_t(1),size_t(boost::thread::hardware_concurrency()));
+   if(s_in_parallel_build || nthreads == 1 || nodes.size() < nthreads) {
+      for(size_t i=0; i<nodes.size(); i++) solids[i] = xcsg_factory::singleton().make_solid(nodes[i]);
+      return;
+   }
+
+   run_concurrently(nodes.size(),[&nodes,&solids](size_t i) {
+      s_in_parallel_build = true;
+      solids[i] = xcsg_factory::singleton().make_solid(nodes[i]);
+   },nthreads);
+}
+
+void xsolid_collector::collect_children(const cf_xmlNode& parent, ShapeSet& A)
+{
+   std::vector<std::shared_ptr<xsolid>> solids;
+   make_solids(parent,solids);
+   A.insert(solids.begin(),solids.end());
 }
 
 void xsolid_collector::collect_children(const cf_xmlNode& parent, ShapeSet& A, size_t nA, ShapeSet& B)
 {
-   size_t icount=0;
-   cf_xmlNode tmp(parent);
-   for(auto i=tmp.begin(); i!=tmp.end(); i++) {
-      cf_xmlNode sub(i);
-      if(xcsg_factory::singleton().is_solid(sub)) {
-         if(icount < nA) {
-            A.insert(xcsg_factory::singleton().make_solid(sub));
-         }
-         else {
-            B.insert(xcsg_factory::singleton().make_solid(sub));
-         }
-         icount++;
-      }
-   }
-   if(icount == 0) {
-      throw logic_error("Expected solids under " + parent.tag() + ", but found none.");
+   std::vector<std::shared_ptr<xsolid>> solids;
+   make_solids(parent,solids);
+   for(size_t i=0; i<solids.size(); i++) {
+      if(i < nA) A.insert(solids[i]);
+      else       B.insert(solids[i]);
    }
 }
 
 void xsolid_collector::collect_children(const cf_xmlNode& parent, ShapeList& A)
 {
-   size_t icount=0;
-   cf_xmlNode tmp(parent);
-   for(auto i=tmp.begin(); i!=tmp.end(); i++) {
-      cf_xmlNode sub(i);
-      if(xcsg_factory::singleton().is_solid(sub)) {
-         A.push_back(xcsg_factory::singleton().make_solid(sub));
-         icount++;
-      }
-   }
-   if(icount == 0) {
-      throw logic_error("Expected solids under " + parent.tag() + ", but found none.");
-   }
+   std::vector<std::shared_ptr<xsolid>> solids;
+   make_solids(parent,solids);
+   A.insert(A.end(),solids.begin(),solids.end());
 }
@@ -16,8 +16,8 @@
 #include "xtin_model.h"
 #include "primitives3d.h"
 #include <carve/input.hpp>
-#include <map>
 #include "tin_mesh.h"
+#include "csg_parser/cf_xmlPayload.h"
 
 
 
@@ -33,28 +33,23 @@ xtin_model::xtin_model(const cf_xmlNode& const_node)
       cf_xmlNode sub(i);
       if(!sub.is_attribute_node()) {
 
-         if("vertices" == sub.tag()) {
-
-            map<size_t,xvertex> v;
+         auto payload = sub.payload();
+         if("vertices" == sub.tag() && payload) {
+            m_v_payload = payload;
+         }
+         else if("vertices" == sub.tag()) {
             for(auto iv=sub.begin(); iv!=sub.end(); iv++) {
                // get next vertex
                cf_xmlNode vertex(iv);
                if("vertex" == vertex.tag()) {
-                  size_t id = v.size();
-                  v[id]= carve::geom::VECTOR( vertex.get_property("x",0.0),
-                                              vertex.get_property("y",0.0),
-                                              vertex.get_property("z",0.0));
+                  m_vertices.push_back(carve::geom::VECTOR( vertex.get_property("x",0.0),
+                                                            vertex.get_property("y",0.0),
+                                                            vertex.get_property("z",0.0)));
                }
                else {
                   throw logic_error("tin_model: expected tag 'vertex' but found " + vertex.tag());
                }
             }
-
-            // copy to member variable
-            m_vertices.resize(v.size());
-            for(auto i=v.begin(); i!=v.end(); i++) {
-               m_vertices[i->first] = i->second;
-            }
          }
       }
    }
@@ -63,12 +58,31 @@ xtin_model::xtin_model(const cf_xmlNode& const_node)
 xtin_model::~xtin_model()
 {}
 
+bool xtin_model::bounding_box(const carve::math::Matrix& t, xvertex& pmin, xvertex& pmax) const
+{
+   std::vector<double> xyz;
+   if(m_v_payload) {
+      cf_xmlArray<double> c = m_v_payload->values();
+      if(m_vertices.size() == 0) return vertex_box(t,c.data(),c.size()/3,pmin,pmax);
+      xyz.assign(c.begin(),c.end());
+   }
+   for(auto& v : m_vertices) xyz.insert(xyz.end(),{v.x,v.y,v.z});
+   return vertex_box(t,xyz.data(),xyz.size()/3,pmin,pmax);
+}
+
 
 std::shared_ptr<carve::mesh::MeshSet<3>> xtin_model::create_carve_mesh(const carve::math::Matrix& t) const
 {
    // create a neutral vector of vertices for tin_mesh
    std::vector<tin_mesh::txyz>  vert;
-   vert.reserve(m_vertices.size());
+   if(m_v_payload) {
+      cf_xmlArray<double> c = m_v_payload->values();
+      vert.reserve(c.size()/3);
+      for(size_t iv=0; iv<c.size()/3; iv++) {
+         vert.push_back(tin_mesh::txyz(c[3*iv],c[3*iv+1],c[3*iv+2]));
+      }
+   }
+   vert.reserve(vert.size()+m_vertices.size());
    for(auto& v : m_vertices) {
       vert.push_back(tin_mesh::txyz(v.x,v.y,v.z));
    }
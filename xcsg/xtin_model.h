@@ -17,6 +17,7 @@
 #define XTIN_MODEL_H
 
 #include "xsolid.h"
+class cf_xmlPayload;
 
 
 class xtin_model : public xsolid {
@@ -26,10 +27,13 @@ public:
 
    std::shared_ptr<carve::mesh::MeshSet<3>> create_carve_mesh(const carve::math::Matrix& t = carve::math::Matrix()) const;
 
+   bool bounding_box(const carve::math::Matrix& t, xvertex& pmin, xvertex& pmax) const;
+
 protected:
 
 private:
-   std::vector<xvertex> m_vertices;  // vertex coordinates
+   std::vector<xvertex> m_vertices;  // vertex coordinates, when not given as payload
+   std::shared_ptr<const cf_xmlPayload> m_v_payload;  // <vertices>, read in create_carve_mesh
 };
 
 #endif // XTIN_MODEL_H
@@ -14,7 +14,9 @@
 // EndLicense:
 
 #include "xtmatrix.h"
+#include <algorithm>
 #include "csg_parser/cf_xmlNode.h"
+#include "csg_parser/cf_xmlPayload.h"
 
 xtmatrix::xtmatrix()
 {}
@@ -25,6 +27,15 @@ xtmatrix::xtmatrix(carve::math::Matrix& t)
 
 xtmatrix::xtmatrix(cf_xmlNode& node)
 {
+   if(auto payload = node.payload()) {
+      cf_xmlArray<double> c = payload->values();
+      size_t nrow = std::min(size_t(4),c.size()/4);
+      for(size_t irow=0; irow<nrow; irow++) {
+         for(size_t icol=0; icol<4; icol++) m_t.m[icol][irow] = c[4*irow+icol];
+      }
+      return;
+   }
+
    int irow = 0;
    for(auto i=node.begin();i!=node.end();i++) {
       cf_xmlNode row(i);
@@ -0,0 +1,223 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "zip_streambuf.h"
+#include <zlib.h>
+#include <algorithm>
+#include <ctime>
+#include <stdexcept>
+
+// little endian field helpers for the zip records
+static void put16(std::vector<unsigned char>& b, uint16_t v) { b.push_back(v & 0xff); b.push_back((v>>8) & 0xff); }
+static void put32(std::vector<unsigned char>& b, uint32_t v) { put16(b,v & 0xffff); put16(b,(v>>16) & 0xffff); }
+
+static const uint16_t zip_version = 20;     // 2.0: deflate
+static const uint16_t zip_flags   = 0x0008; // sizes and crc follow the data in a descriptor
+static const uint16_t zip_deflate = 8;
+
+zip_streambuf::zip_streambuf(const std::string& zip_path, const std::string& entry_name)
+: m_path(zip_path)
+, m_entry_name(entry_name)
+, m_file(0)
+, m_zstream(0)
+, m_crc(0)
+, m_usize(0)
+, m_csize(0)
+, m_dos_time(0)
+, m_dos_date(0)
+, m_in(1<<20)
+, m_out(1<<20)
+, m_closed(false)
+{
+   m_file = std::fopen(zip_path.c_str(),"wb");
+   if(!m_file) throw std::logic_error("zip_streambuf: Failed to open: " + zip_path);
+
+   // raw deflate stream, the zip records replace the zlib header
+   z_stream* zs = new z_stream();
+   zs->zalloc = Z_NULL;
+   zs->zfree  = Z_NULL;
+   zs->opaque = Z_NULL;
+   if(deflateInit2(zs,Z_DEFAULT_COMPRESSION,Z_DEFLATED,-MAX_WBITS,8,Z_DEFAULT_STRATEGY) != Z_OK) {
+      delete zs;
+      std::fclose(m_file);
+      throw std::logic_error("zip_streambuf: deflate initialisation failed");
+   }
+   m_zstream = zs;
+   m_crc     = static_cast<uint32_t>(crc32(0L,Z_NULL,0));
+
+   time_t now = time(0);
+   struct tm* t = localtime(&now);
+   m_dos_time = static_cast<uint16_t>((t->tm_hour<<11) | (t->tm_min<<5) | (t->tm_sec/2));
+   m_dos_date = static_cast<uint16_t>(((t->tm_year-80)<<9) | ((t->tm_mon+1)<<5) | t->tm_mday);
+
+   // local file header
+   std::vector<unsigned char> b;
+   put32(b,0x04034b50);
+   put16(b,zip_version);
+   put16(b,zip_flags);
+   put16(b,zip_deflate);
+   put16(b,m_dos_time);
+   put16(b,m_dos_date);
+   put32(b,0);   // crc, in data descriptor
+   put32(b,0);   // compressed size, in data descriptor
+   put32(b,0);   // uncompressed size, in data descriptor
+   put16(b,static_cast<uint16_t>(m_entry_name.length()));
+   put16(b,0);   // extra field length
+   b.insert(b.end(),m_entry_name.begin(),m_entry_name.end());
+   write_bytes(b);
+
+   setp(m_in.data(),m_in.data()+m_in.size());
+}
+
+zip_streambuf::~zip_streambuf()
+{
+   try {
+      if(!m_closed) close();
+   }
+   catch(...) {}
+   if(m_zstream) {
+      z_stream* zs = static_cast<z_stream*>(m_zstream);
+      deflateEnd(zs);
+      delete zs;
+   }
+   if(m_file) std::fclose(m_file);
+}
+
+void zip_streambuf::write_bytes(const std::vector<unsigned char>& bytes)
+{
+   if(std::fwrite(bytes.data(),1,bytes.size(),m_file) != bytes.size()) {
+      throw std::logic_error("zip_streambuf: Failed to write: " + m_path);
+   }
+}
+
+void zip_streambuf::flush_input(const char* data, size_t n, bool finish)
+{
+   z_stream* zs = static_cast<z_stream*>(m_zstream);
+
+   // the pending put area first, then the data given
+   const char* chunks[2]  = { pbase(), data };
+   size_t      lengths[2] = { size_t(pptr()-pbase()), n };
+   setp(m_in.data(),m_in.data()+m_in.size());
+
+   for(size_t ichunk=0; ichunk<2; ichunk++) {
+      const char* p = chunks[ichunk];
+      size_t len    = lengths[ichunk];
+      bool last     = finish && (ichunk==1);
+      do {
+         // zlib counts in 32 bit, feed very large writes in pieces
+         uInt piece = static_cast<uInt>(std::min(len,size_t(1)<<30));
+         if(piece > 0) m_crc = static_cast<uint32_t>(crc32(m_crc,reinterpret_cast<const Bytef*>(p),piece));
+         m_usize += piece;
+
+         zs->next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(p));
+         zs->avail_in = piece;
+         p   += piece;
+         len -= piece;
+         int flush = (last && len==0)? Z_FINISH : Z_NO_FLUSH;
+         int ret   = Z_OK;
+         do {
+            zs->next_out  = reinterpret_cast<Bytef*>(m_out.data());
+            zs->avail_out = static_cast<uInt>(m_out.size());
+            ret = deflate(zs,flush);
+            if(ret == Z_STREAM_ERROR) throw std::logic_error("zip_streambuf: deflate failed");
+            size_t have = m_out.size() - zs->avail_out;
+            if(std::fwrite(m_out.data(),1,have,m_file) != have) throw std::logic_error("zip_streambuf: Failed to write: " + m_path);
+            m_csize += have;
+         } while(zs->avail_out == 0 || (flush==Z_FINISH && ret!=Z_STREAM_END));
+      } while(len > 0);
+   }
+}
+
+zip_streambuf::int_type zip_streambuf::overflow(int_type c)
+{
+   if(m_closed) return traits_type::eof();
+   flush_input(0,0,false);
+   if(!traits_type::eq_int_type(c,traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+   }
+   return traits_type::not_eof(c);
+}
+
+std::streamsize zip_streambuf::xsputn(const char* s, std::streamsize n)
+{
+   if(m_closed) return 0;
+   if(n <= epptr()-pptr()) {
+      std::copy(s,s+n,pptr());
+      pbump(static_cast<int>(n));
+   }
+   else {
+      // large writes are compressed directly without copying
+      flush_input(s,static_cast<size_t>(n),false);
+   }
+   return n;
+}
+
+void zip_streambuf::close()
+{
+   if(m_closed) return;
+   m_closed = true;
+
+   flush_input(0,0,true);
+   if(m_usize > 0xffffffffu || m_csize > 0xffffffffu) {
+      throw std::logic_error("zip_streambuf: entry larger than 4GB, zip64 is not supported: " + m_path);
+   }
+   uint32_t cd_offset = static_cast<uint32_t>(30 + m_entry_name.length() + m_csize + 16);
+
+   std::vector<unsigned char> b;
+
+   // data descriptor
+   put32(b,0x08074b50);
+   put32(b,m_crc);
+   put32(b,static_cast<uint32_t>(m_csize));
+   put32(b,static_cast<uint32_t>(m_usize));
+
+   // central directory, single entry
+   size_t cd_begin = b.size();
+   put32(b,0x02014b50);
+   put16(b,zip_version);  // version made by
+   put16(b,zip_version);  // version needed
+   put16(b,zip_flags);
+   put16(b,zip_deflate);
+   put16(b,m_dos_time);
+   put16(b,m_dos_date);
+   put32(b,m_crc);
+   put32(b,static_cast<uint32_t>(m_csize));
+   put32(b,static_cast<uint32_t>(m_usize));
+   put16(b,static_cast<uint16_t>(m_entry_name.length()));
+   put16(b,0);   // extra field length
+   put16(b,0);   // comment length
+   put16(b,0);   // disk number
+   put16(b,0);   // internal attributes
+   put32(b,0);   // external attributes
+   put32(b,0);   // local header offset
+   b.insert(b.end(),m_entry_name.begin(),m_entry_name.end());
+   uint32_t cd_size = static_cast<uint32_t>(b.size() - cd_begin);
+
+   // end of central directory
+   put32(b,0x06054b50);
+   put16(b,0);   // disk number
+   put16(b,0);   // disk with central directory
+   put16(b,1);   // entries on this disk
+   put16(b,1);   // entries total
+   put32(b,cd_size);
+   put32(b,cd_offset);
+   put16(b,0);   // comment length
+   write_bytes(b);
+
+   int ret = std::fclose(m_file);
+   m_file = 0;
+   if(ret != 0) throw std::logic_error("zip_streambuf: Failed to write: " + m_path);
+}
@@ -0,0 +1,62 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef ZIP_STREAMBUF_H
+#define ZIP_STREAMBUF_H
+
+#include <cstdint>
+#include <cstdio>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// zip_streambuf writes a zip archive with a single deflate compressed entry.
+// Data is compressed as it is written, so the uncompressed entry never exists
+// in memory or on disk. Use with std::ostream, then call close().
+// The archive is limited to 4GB (no zip64).
+
+class zip_streambuf : public std::streambuf {
+public:
+   zip_streambuf(const std::string& zip_path, const std::string& entry_name);
+   virtual ~zip_streambuf();
+
+   // complete the entry and write the zip directory, throws on error
+   void close();
+
+protected:
+   virtual int_type overflow(int_type c);
+   virtual std::streamsize xsputn(const char* s, std::streamsize n);
+
+private:
+   // compress the pending put area, then the given data
+   void flush_input(const char* data, size_t n, bool finish);
+   void write_bytes(const std::vector<unsigned char>& bytes);
+
+private:
+   std::string   m_path;
+   std::string   m_entry_name;
+   FILE*         m_file;
+   void*         m_zstream;    // z_stream, kept opaque to avoid zlib.h in the header
+   uint32_t      m_crc;
+   uint64_t      m_usize;      // uncompressed size
+   uint64_t      m_csize;      // compressed size
+   uint16_t      m_dos_time;
+   uint16_t      m_dos_date;
+   std::vector<char> m_in;     // put area
+   std::vector<char> m_out;    // deflate output
+   bool          m_closed;
+};
+
+#endif // ZIP_STREAMBUF_H
@@ -0,0 +1,126 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "micro_bench.h"
+#include "primitives3d.h"
+#include "carve_boolean.h"
+#include "carve_triangulate.h"
+#include "convex_polygon.h"
+#include "xpolyhedron.h"
+#include "qhull/qhull3d.h"
+#include <sstream>
+#include <random>
+#include <cmath>
+
+// carve related kernels, argument is number of segments in the input primitive.
+
+// a cylinder has 2 large polygon caps, the rest is quads
+static std::shared_ptr<xpolyhedron> make_cylinder(int nseg)
+{
+   return primitives3d::make_cone(10.0,10.0,20.0,false,nseg);
+}
+
+static void bm_carve_triangulate(bench_state& state)
+{
+   std::shared_ptr<carve::poly::Polyhedron> poly = make_cylinder(static_cast<int>(state.arg()))->create_carve_polyhedron();
+
+   size_t ntri = 0;
+   for(auto _ : state) {
+      carve_triangulate triangulate;
+      bool improve      = true;
+      bool canonicalize = true;
+      bool degen_check  = true;
+      ntri = triangulate.compute(poly,improve,canonicalize,degen_check);
+   }
+   state.set_items_processed(poly->faces.size()*state.iterations());
+   state.set_label(std::to_string(ntri) + " triangles");
+}
+MICRO_BENCH(bm_carve_triangulate)->range(16,4096);
+
+// a regular n-gon, as found in cylinder caps and extrusions
+static std::vector<carve::geom2d::P2> make_ngon(int nseg)
+{
+   std::vector<carve::geom2d::P2> p(nseg);
+   for(int i=0; i<nseg; i++) {
+      double angle = 2.0*M_PI*i/nseg;
+      p[i] = carve::geom::VECTOR(10.0*cos(angle),10.0*sin(angle));
+   }
+   return p;
+}
+
+// general polygon triangulation, items are triangles
+static void bm_triangulate_ngon_general(bench_state& state)
+{
+   std::vector<carve::geom2d::P2> p = make_ngon(static_cast<int>(state.arg()));
+   std::vector<carve::triangulate::tri_idx> result;
+   for(auto _ : state) {
+      result.clear();
+      carve::triangulate::triangulate(p,result);
+      carve::triangulate::improve(p,result);
+      do_not_optimize(result.data());
+   }
+   state.set_items_processed(result.size()*state.iterations());
+}
+MICRO_BENCH(bm_triangulate_ngon_general)->range(4,1024,4);
+
+// convex fast path including the convexity test, items are triangles
+static void bm_triangulate_ngon_convex(bench_state& state)
+{
+   std::vector<carve::geom2d::P2> p = make_ngon(static_cast<int>(state.arg()));
+   std::vector<carve::triangulate::tri_idx> result;
+   for(auto _ : state) {
+      if(convex_polygon::is_convex(p)) convex_polygon::triangulate(p,result);
+      do_not_optimize(result.data());
+   }
+   state.set_items_processed(result.size()*state.iterations());
+}
+MICRO_BENCH(bm_triangulate_ngon_convex)->range(4,1024,4);
+
+static void bm_check_polyhedron(bench_state& state)
+{
+   std::shared_ptr<xpolyhedron> poly = primitives3d::make_geodesic_sphere(10.0,static_cast<int>(state.arg()));
+
+   for(auto _ : state) {
+      std::ostringstream out;
+      size_t num_non_tri = 0;
+      poly->check_polyhedron(out,num_non_tri);
+      do_not_optimize(num_non_tri);
+   }
+   state.set_items_processed(poly->f_size()*state.iterations());
+   state.set_label(std::to_string(poly->f_size()) + " faces");
+}
+MICRO_BENCH(bm_check_polyhedron)->range(8,512,4);
+
+static void bm_qhull3d_compute(bench_state& state)
+{
+   // random points in a unit cube, fixed seed
+   size_t npoints = static_cast<size_t>(state.arg());
+   std::mt19937 gen(12345);
+   std::uniform_real_distribution<double> dist(-1.0,1.0);
+   std::vector<double> coords(3*npoints);
+   for(auto& c : coords) c = dist(gen);
+
+   size_t nface = 0;
+   for(auto _ : state) {
+      qhull3d qhull;
+      qhull.reserve(npoints);
+      for(size_t i=0; i<npoints; i++) qhull.push_back(coords[3*i],coords[3*i+1],coords[3*i+2]);
+      qhull.compute();
+      nface = qhull.nfaces();
+   }
+   state.set_items_processed(npoints*state.iterations());
+   state.set_label(std::to_string(nface) + " hull faces");
+}
+MICRO_BENCH(bm_qhull3d_compute)->range(64,262144);
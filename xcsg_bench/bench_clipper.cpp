@@ -0,0 +1,48 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "micro_bench.h"
+#include "clipper_boolean.h"
+#include "primitives2d.h"
+#include <carve/matrix.hpp>
+
+// union of N overlapping circles placed on a grid, argument is N
+
+static void bm_clipper_union(bench_state& state)
+{
+   size_t n = static_cast<size_t>(state.arg());
+   size_t ncol = 1;
+   while(ncol*ncol < n) ncol++;
+
+   std::vector<std::shared_ptr<clipper_profile>> profiles;
+   profiles.reserve(n);
+   for(size_t i=0; i<n; i++) {
+      carve::math::Matrix t = carve::math::Matrix::TRANS(15.0*(i%ncol),15.0*(i/ncol),0.0);
+      std::shared_ptr<polygon2d> poly = primitives2d::make_circle(10.0,64,t);
+      std::shared_ptr<clipper_profile> profile(new clipper_profile);
+      profile->AddPaths(poly->paths());
+      profiles.push_back(profile);
+   }
+
+   for(auto _ : state) {
+      clipper_boolean csg;
+      for(auto& profile : profiles) {
+         csg.compute(profile,ClipperLib::ctUnion);
+      }
+      do_not_optimize(csg.profile());
+   }
+   state.set_items_processed(n*state.iterations());
+}
+MICRO_BENCH(bm_clipper_union)->range(4,1024,4);
@@ -0,0 +1,68 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "micro_bench.h"
+#include "primitives3d.h"
+#include "lump_mesh.h"
+#include "out_triangles.h"
+#include <boost/filesystem.hpp>
+#include <functional>
+
+// binary STL and PLY export of a triangulated geodesic sphere, argument is number of segments.
+// The files are written to the system temporary directory, the label shows the file size.
+
+static std::shared_ptr<out_triangles::lump_vector> make_sphere_lumps(int nseg)
+{
+   std::shared_ptr<xpolyhedron> poly = primitives3d::make_geodesic_sphere(10.0,nseg);
+   auto lumps = std::make_shared<out_triangles::lump_vector>(1,std::make_shared<lump_mesh>());
+   lump_mesh& lump = *lumps->front();
+   for(size_t iv=0; iv<poly->v_size(); iv++) lump.v_add(poly->v_get(iv));
+   for(size_t iface=0; iface<poly->f_size(); iface++) {
+      const xface& face = poly->f_get(iface);
+      uint32_t ind[3] = { uint32_t(face[0]), uint32_t(face[1]), uint32_t(face[2]) };
+      lump.f_add(ind,3);
+   }
+   return lumps;
+}
+
+static void bench_write(bench_state& state, const std::function<std::string(out_triangles&,const std::string&)>& write)
+{
+   auto lumps = make_sphere_lumps(static_cast<int>(state.arg()));
+
+   boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("xcsg_bench_%%%%%%%%.xcsg");
+   std::string out_path;
+   for(auto _ : state) {
+      out_triangles exporter(lumps);
+      out_path = write(exporter,path.string());
+   }
+
+   size_t nbytes = boost::filesystem::file_size(out_path);
+   state.set_bytes_processed(nbytes*state.iterations());
+   state.set_label(std::to_string(lumps->front()->f_size()) + " triangles, " + std::to_string(nbytes) + " bytes");
+   boost::system::error_code ec;
+   boost::filesystem::remove(out_path,ec);
+}
+
+static void bm_write_stl_binary(bench_state& state)
+{
+   bench_write(state,[](out_triangles& exporter, const std::string& path) { return exporter.write_stl(path,true); });
+}
+MICRO_BENCH(bm_write_stl_binary)->range(8,512,4);
+
+static void bm_write_ply_binary(bench_state& state)
+{
+   bench_write(state,[](out_triangles& exporter, const std::string& path) { return exporter.write_ply(path); });
+}
+MICRO_BENCH(bm_write_ply_binary)->range(8,512,4);
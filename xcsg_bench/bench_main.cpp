@@ -0,0 +1,54 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <limits>
+#include "micro_bench.h"
+#include "boolean_timer.h"
+
+// xcsg_bench runs microbenchmarks for the xcsg geometry kernels.
+//
+//   xcsg_bench [--filter <text>] [--min_time <sec>]
+
+int main(int argc, char **argv)
+{
+   std::string filter;
+   double min_time = 0.5;
+
+   for(int i=1; i<argc; i++) {
+      std::string a(argv[i]);
+      if(a=="--filter" && i+1<argc)        filter   = argv[++i];
+      else if(a=="--min_time" && i+1<argc) min_time = std::atof(argv[++i]);
+      else {
+         std::cout << "usage: xcsg_bench [--filter <text>] [--min_time <sec>]" << std::endl;
+         return 1;
+      }
+   }
+
+   // kernels report to the boolean timer, keep its progress output silent
+   boolean_timer::singleton().init(std::numeric_limits<int>::max());
+
+   try {
+      size_t nrun = micro_bench::singleton().run(filter,min_time);
+      if(nrun == 0) std::cout << "no benchmarks matching '" << filter << "'" << std::endl;
+   }
+   catch(std::exception& ex) {
+      std::cout << "xcsg_bench finished with exception: " << ex.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,82 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "micro_bench.h"
+#include "primitives2d.h"
+#include "clipper_csg/tmesh_adapter.h"
+#include "clipper_csg/polyset2d.h"
+#include "dmesh/dmesh.h"
+#include <cmath>
+
+// 2d profile tesselation, argument is number of segments in the outer contour.
+// The profile is a circle with a circular hole.
+
+static std::vector<dpos2d> circle_points(double r, size_t nseg, bool ccw)
+{
+   std::vector<dpos2d> points;
+   points.reserve(nseg);
+   const double pi = 4.0*std::atan(1.0);
+   for(size_t i=0; i<nseg; i++) {
+      double angle = 2*pi*i/nseg;
+      if(!ccw) angle = -angle;
+      points.push_back(dpos2d(r*std::cos(angle),r*std::sin(angle)));
+   }
+   return points;
+}
+
+static void bm_tmesh_tesselate(bench_state& state)
+{
+   int nseg = static_cast<int>(state.arg());
+   std::shared_ptr<polygon2d> outer = primitives2d::make_circle(10.0,nseg);
+   std::shared_ptr<polygon2d> inner = primitives2d::make_circle(5.0,nseg/2);
+
+   // build a single polygon with a hole, hole contour reversed to CW
+   std::shared_ptr<polygon2d> profile(new polygon2d);
+   profile->push_back(outer->get_contour(0));
+   std::shared_ptr<contour2d> hole(new contour2d(*inner->get_contour(0)));
+   hole->reverse();
+   profile->push_back(hole);
+
+   std::shared_ptr<polyset2d> polyset(new polyset2d);
+   polyset->push_back(profile);
+
+   for(auto _ : state) {
+      tmesh_adapter tess;
+      tess.tesselate(polyset);
+      do_not_optimize(tess.mesh());
+   }
+   state.set_items_processed(nseg*state.iterations());
+}
+MICRO_BENCH(bm_tmesh_tesselate)->range(16,16384);
+
+static void bm_dmesh_triangulate_profile(bench_state& state)
+{
+   size_t nseg = static_cast<size_t>(state.arg());
+   std::vector<dpos2d> outer = circle_points(10.0,nseg,true);
+   std::vector<dpos2d> inner = circle_points(5.0,nseg/2,false);
+
+   size_t ntri = 0;
+   for(auto _ : state) {
+      dmesh mesh;
+      mesh.reserve_vertices(outer.size()+inner.size());
+      mesh.add_loop(outer);
+      mesh.add_loop(inner);
+      mesh.triangulate_profile();
+      ntri = mesh.size();
+   }
+   state.set_items_processed(nseg*state.iterations());
+   state.set_label(std::to_string(ntri) + " triangles");
+}
+MICRO_BENCH(bm_dmesh_triangulate_profile)->range(16,16384);
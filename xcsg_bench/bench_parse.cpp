@@ -0,0 +1,269 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "micro_bench.h"
+#include "csg_parser/cf_xmlTree.h"
+#include "csg_parser/csg_parser.h"
+#include <boost/filesystem.hpp>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <vector>
+
+// reading a polyhedron triangle strip from .xcsg, argument is number of vertices.
+// bm_read_xml_ptree uses the boost property tree, bm_read_xcsg_pull the pull parser with payloads
+// bm_read_xcsgb the binary form and bm_read_xcsg_json the same polyhedron as .xcsg.json.
+
+// unique file in the temp directory, removed when it goes out of scope
+class temp_file {
+public:
+   temp_file(const std::string& extension)
+   : m_path((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("xcsg_bench_%%%%%%%%" + extension)).string())
+   {}
+
+   ~temp_file()
+   {
+      boost::system::error_code ec;
+      boost::filesystem::remove(m_path,ec);
+   }
+
+   const std::string& path() const { return m_path; }
+
+private:
+   temp_file(const temp_file&) = delete;
+   temp_file& operator=(const temp_file&) = delete;
+
+   std::string m_path;
+};
+
+// time reader on the file at path, reader returns false when the file could not be read
+static void bench_read(bench_state& state, const std::string& path, const std::function<bool(const std::string&)>& reader)
+{
+   for(auto _ : state) {
+      if(!reader(path)) throw std::logic_error("bench_read: could not read " + path);
+   }
+
+   size_t nbytes = boost::filesystem::file_size(path);
+   state.set_bytes_processed(nbytes*state.iterations());
+   state.set_label(std::to_string(nbytes) + " bytes");
+}
+
+static bool read_xml(const std::string& path)       { cf_xmlTree tree; return tree.read_xml(path);       }
+static bool read_xcsg(const std::string& path)      { cf_xmlTree tree; return tree.read_xcsg(path);      }
+static bool read_binary(const std::string& path)    { cf_xmlTree tree; return tree.read_binary(path);    }
+static bool read_xcsg_json(const std::string& path) { cf_xmlTree tree; return tree.read_xcsg_json(path); }
+
+static void write_polyhedron_file(const std::string& path, size_t nvert)
+{
+   std::ofstream out(path);
+   out.precision(17);
+   out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<xcsg version=\"1.0\">\n\t<polyhedron>\n\t\t<vertices>\n";
+   for(size_t iv=0; iv<nvert; iv++) {
+      double t = 0.001*iv;
+      out << "\t\t\t<vertex x=\"" << 10*std::cos(t) << "\" y=\"" << 10*std::sin(t) << "\" z=\"" << t << "\"/>\n";
+   }
+   out << "\t\t</vertices>\n\t\t<faces>\n";
+   for(size_t iv=0; iv+2<nvert; iv++) {
+      out << "\t\t\t<face>\n\t\t\t\t<fv index=\"" << iv << "\"/>\n\t\t\t\t<fv index=\"" << iv+1 << "\"/>\n\t\t\t\t<fv index=\"" << iv+2 << "\"/>\n\t\t\t</face>\n";
+   }
+   out << "\t\t</faces>\n\t</polyhedron>\n</xcsg>\n";
+}
+
+// tin_model with nvert vertices, encoding is "" for one <vertex> element per vertex, "text" or "base64"
+static void write_tin_file(const std::string& path, size_t nvert, const std::string& encoding)
+{
+   std::vector<double> xyz;
+   xyz.reserve(3*nvert);
+   size_t nx = static_cast<size_t>(std::sqrt(double(nvert)))+1;
+   for(size_t iv=0; iv<nvert; iv++) {
+      double x = 0.5*(iv%nx);
+      double y = 0.5*(iv/nx);
+      xyz.push_back(x);
+      xyz.push_back(y);
+      xyz.push_back(std::sin(0.1*x)*std::cos(0.1*y));
+   }
+
+   std::ofstream out(path,std::ios::binary);
+   out.precision(17);
+   out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<xcsg version=\"1.0\">\n\t<tin_model>\n";
+   if(encoding == "") {
+      out << "\t\t<vertices>\n";
+      for(size_t iv=0; iv<nvert; iv++) {
+         out << "\t\t\t<vertex x=\"" << xyz[3*iv] << "\" y=\"" << xyz[3*iv+1] << "\" z=\"" << xyz[3*iv+2] << "\"/>\n";
+      }
+   }
+   else if(encoding == "text") {
+      out << "\t\t<vertices count=\"" << nvert << "\" encoding=\"text\">\n";
+      for(size_t iv=0; iv<nvert; iv++) {
+         out << xyz[3*iv] << ' ' << xyz[3*iv+1] << ' ' << xyz[3*iv+2] << '\n';
+      }
+   }
+   else {
+      out << "\t\t<vertices count=\"" << nvert << "\" encoding=\"base64\">\n";
+      const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      const unsigned char* bytes = reinterpret_cast<const unsigned char*>(xyz.data());
+      size_t nbytes = xyz.size()*sizeof(double);
+      for(size_t i=0; i<nbytes; i+=3) {
+         unsigned int b = bytes[i] << 16;
+         if(i+1 < nbytes) b |= bytes[i+1] << 8;
+         if(i+2 < nbytes) b |= bytes[i+2];
+         out << chars[(b>>18)&63] << chars[(b>>12)&63];
+         out << ((i+1 < nbytes)? chars[(b>>6)&63] : '=');
+         out << ((i+2 < nbytes)? chars[b&63] : '=');
+         if(i%57 == 54) out << '\n';
+      }
+   }
+   out << "\t\t</vertices>\n\t</tin_model>\n</xcsg>\n";
+}
+
+static void bench_read_tin(bench_state& state, const std::string& encoding)
+{
+   temp_file file(".xcsg");
+   write_tin_file(file.path(),static_cast<size_t>(state.arg()),encoding);
+   bench_read(state,file.path(),read_xcsg);
+}
+
+static void bm_read_xml_ptree(bench_state& state)
+{
+   temp_file file(".xcsg");
+   write_polyhedron_file(file.path(),static_cast<size_t>(state.arg()));
+   bench_read(state,file.path(),read_xml);
+}
+MICRO_BENCH(bm_read_xml_ptree)->range(1000,1000000,10);
+
+static void bm_read_xcsg_pull(bench_state& state)
+{
+   temp_file file(".xcsg");
+   write_polyhedron_file(file.path(),static_cast<size_t>(state.arg()));
+   bench_read(state,file.path(),read_xcsg);
+}
+MICRO_BENCH(bm_read_xcsg_pull)->range(1000,1000000,10);
+
+// tin_model vertices, one element per vertex versus compact encodings
+static void bm_read_tin_elements(bench_state& state) { bench_read_tin(state,"");       }
+static void bm_read_tin_text(bench_state& state)     { bench_read_tin(state,"text");   }
+static void bm_read_tin_base64(bench_state& state)   { bench_read_tin(state,"base64"); }
+MICRO_BENCH(bm_read_tin_elements)->range(1000,1000000,10);
+MICRO_BENCH(bm_read_tin_text)->range(1000,1000000,10);
+MICRO_BENCH(bm_read_tin_base64)->range(1000,1000000,10);
+
+// the polyhedron of bm_read_xcsg_pull, converted to .xcsgb and memory mapped
+static void bm_read_xcsgb(bench_state& state)
+{
+   temp_file xml_file(".xcsg");
+   temp_file file(".xcsgb");
+   write_polyhedron_file(xml_file.path(),static_cast<size_t>(state.arg()));
+   {
+      cf_xmlTree tree;
+      if(!tree.read_xcsg(xml_file.path()) || !tree.write_binary(file.path())) throw std::logic_error("bm_read_xcsgb: could not convert " + xml_file.path());
+   }
+   bench_read(state,file.path(),read_binary);
+}
+MICRO_BENCH(bm_read_xcsgb)->range(1000,1000000,10);
+
+// the polyhedron of bm_read_xcsg_pull as .xcsg.json with numeric rows, read in a single pass
+static void write_polyhedron_json(const std::string& path, size_t nvert)
+{
+   std::ofstream out(path);
+   out.precision(17);
+   out << "{\"xcsg\": {\"<xmlattr>\": {\"version\": \"1.0\"},\n  \"polyhedron\": {\n    \"vertices\": [";
+   for(size_t iv=0; iv<nvert; iv++) {
+      double t = 0.001*iv;
+      out << ((iv>0)? ",\n      [" : "\n      [") << 10*std::cos(t) << ", " << 10*std::sin(t) << ", " << t << "]";
+   }
+   out << "],\n    \"faces\": [";
+   for(size_t iv=0; iv+2<nvert; iv++) {
+      out << ((iv>0)? ",\n      [" : "\n      [") << iv << ", " << iv+1 << ", " << iv+2 << "]";
+   }
+   out << "]}}}\n";
+}
+
+static void bm_read_xcsg_json(bench_state& state)
+{
+   temp_file file(".xcsg.json");
+   write_polyhedron_json(file.path(),static_cast<size_t>(state.arg()));
+   bench_read(state,file.path(),read_xcsg_json);
+}
+MICRO_BENCH(bm_read_xcsg_json)->range(1000,1000000,10);
+
+// OpenSCAD .csg polyhedron(points=[...],faces=[...]) with nvert points, converted to an xcsg tree
+static void write_polyhedron_csg(const std::string& path, size_t nvert)
+{
+   std::ofstream out(path);
+   out.precision(17);
+   out << "group() {\n\tpolyhedron(points = [";
+   for(size_t iv=0; iv<nvert; iv++) {
+      double t = 0.001*iv;
+      out << ((iv>0)? ", [" : "[") << 10*std::cos(t) << ", " << 10*std::sin(t) << ", " << t << "]";
+   }
+   out << "], faces = [";
+   for(size_t iv=0; iv+2<nvert; iv++) {
+      out << ((iv>0)? ", [" : "[") << iv << ", " << iv+1 << ", " << iv+2 << "]";
+   }
+   out << "], convexity = 1);\n}\n";
+}
+
+static void bm_convert_csg_polyhedron(bench_state& state)
+{
+   temp_file file(".csg");
+   write_polyhedron_csg(file.path(),static_cast<size_t>(state.arg()));
+   bench_read(state,file.path(),[](const std::string& path) {
+      csg_parser parser(path,0.05);
+      cf_xmlTree tree;
+      parser.to_xcsg(tree);
+      return true;
+   });
+}
+MICRO_BENCH(bm_convert_csg_polyhedron)->range(1000,1000000,10);
+
+// property lookups as done by the factory: r and center of N transformed spheres, plus the tmatrix rows
+static void bm_node_properties(bench_state& state)
+{
+   size_t nnodes = static_cast<size_t>(state.arg());
+   std::ostringstream xml;
+   xml << "<xcsg>";
+   for(size_t i=0; i<nnodes; i++) {
+      xml << "<sphere r=\"" << 1+0.001*i << "\" center=\"true\"><tmatrix>"
+          << "<trow c0=\"1\" c1=\"0\" c2=\"0\" c3=\"" << i << "\"/><trow c0=\"0\" c1=\"1\" c2=\"0\" c3=\"0\"/>"
+          << "<trow c0=\"0\" c1=\"0\" c2=\"1\" c3=\"0\"/><trow c0=\"0\" c1=\"0\" c2=\"0\" c3=\"1\"/>"
+          << "</tmatrix></sphere>";
+   }
+   xml << "</xcsg>";
+   std::istringstream in(xml.str());
+   cf_xmlTree tree;
+   cf_xmlNode root;
+   if(!tree.read_xml(in) || !tree.get_root(root)) throw std::logic_error("bm_node_properties: could not read tree");
+
+   const std::string names[] = { "c0", "c1", "c2", "c3" };
+   double sum = 0.0;
+   for(auto _ : state) {
+      for(auto i=root.begin(); i!=root.end(); i++) {
+         cf_xmlNode sphere(i);
+         sum += sphere.get_property("r",1.0);
+         if(sphere.get_property("center",std::string("false")) == "true") sum += 1.0;
+         cf_xmlNode tmatrix;
+         if(sphere.get_child("tmatrix",tmatrix)) {
+            for(auto j=tmatrix.begin(); j!=tmatrix.end(); j++) {
+               cf_xmlNode trow(j);
+               for(auto& name : names) sum += trow.get_property(name,0.0);
+            }
+         }
+      }
+   }
+   do_not_optimize(sum);
+   state.set_items_processed(nnodes*state.iterations());
+}
+MICRO_BENCH(bm_node_properties)->range(1000,100000,10);
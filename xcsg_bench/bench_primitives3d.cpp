@@ -0,0 +1,45 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "micro_bench.h"
+#include "primitives3d.h"
+
+// 3d primitive mesh generation, argument is number of segments
+
+static void bm_make_geodesic_sphere(bench_state& state)
+{
+   size_t nface = 0;
+   for(auto _ : state) {
+      std::shared_ptr<xpolyhedron> poly = primitives3d::make_geodesic_sphere(10.0,static_cast<int>(state.arg()));
+      nface = poly->f_size();
+      do_not_optimize(poly);
+   }
+   state.set_items_processed(nface*state.iterations());
+   state.set_label(std::to_string(nface) + " faces");
+}
+MICRO_BENCH(bm_make_geodesic_sphere)->range(8,512,4);
+
+static void bm_make_cone(bench_state& state)
+{
+   size_t nface = 0;
+   for(auto _ : state) {
+      std::shared_ptr<xpolyhedron> poly = primitives3d::make_cone(10.0,5.0,20.0,false,static_cast<int>(state.arg()));
+      nface = poly->f_size();
+      do_not_optimize(poly);
+   }
+   state.set_items_processed(nface*state.iterations());
+   state.set_label(std::to_string(nface) + " faces");
+}
+MICRO_BENCH(bm_make_cone)->range(8,4096);
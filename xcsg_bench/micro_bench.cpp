@@ -0,0 +1,170 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#include "micro_bench.h"
+#include <cstdio>
+
+bench_state::bench_state(int64_t arg, size_t iterations)
+: m_arg(arg)
+, m_iterations(iterations)
+, m_items(0)
+, m_bytes(0)
+, m_elapsed(0.0)
+, m_running(false)
+{}
+
+void bench_state::start()
+{
+   m_start   = clock::now();
+   m_running = true;
+}
+
+void bench_state::stop()
+{
+   if(m_running) {
+      m_elapsed += std::chrono::duration<double>(clock::now() - m_start).count();
+      m_running  = false;
+   }
+}
+
+void bench_state::pause_timing()
+{
+   stop();
+}
+
+void bench_state::resume_timing()
+{
+   start();
+}
+
+bench_state::iterator bench_state::begin()
+{
+   start();
+   return iterator(this,m_iterations);
+}
+
+bool bench_state::iterator::operator!=(const iterator&) const
+{
+   if(m_remaining > 0) return true;
+
+   // loop is finished
+   m_state->stop();
+   return false;
+}
+
+bench_entry::bench_entry(const std::string& name, bench_function func)
+: m_name(name)
+, m_func(func)
+{}
+
+bench_entry* bench_entry::arg(int64_t value)
+{
+   m_args.push_back(value);
+   return this;
+}
+
+bench_entry* bench_entry::range(int64_t lo, int64_t hi, int64_t mult)
+{
+   if(mult < 2) mult = 2;
+   for(int64_t value=lo; value<hi; value*=mult) m_args.push_back(value);
+   m_args.push_back(hi);
+   return this;
+}
+
+micro_bench::micro_bench()
+{}
+
+micro_bench::~micro_bench()
+{
+   for(auto entry : m_entries) delete entry;
+}
+
+bench_entry* micro_bench::add(const std::string& name, bench_function func)
+{
+   m_entries.push_back(new bench_entry(name,func));
+   return m_entries.back();
+}
+
+size_t micro_bench::run(const std::string& filter, double min_time)
+{
+   std::printf("%-44s %14s %12s %16s\n","benchmark","time/iter","iterations","rate");
+   std::printf("%s\n",std::string(89,'-').c_str());
+
+   size_t nrun = 0;
+   for(auto entry : m_entries) {
+      if(filter.length()>0 && entry->name().find(filter)==std::string::npos) continue;
+
+      if(entry->args().size() == 0) {
+         run_one(entry,0,false,min_time);
+         nrun++;
+      }
+      for(int64_t arg : entry->args()) {
+         run_one(entry,arg,true,min_time);
+         nrun++;
+      }
+   }
+   return nrun;
+}
+
+static std::string format_time(double sec)
+{
+   char buf[32];
+   if(sec < 1.0E-6)      std::snprintf(buf,sizeof(buf),"%.1f ns",sec*1.0E9);
+   else if(sec < 1.0E-3) std::snprintf(buf,sizeof(buf),"%.2f us",sec*1.0E6);
+   else if(sec < 1.0)    std::snprintf(buf,sizeof(buf),"%.3f ms",sec*1.0E3);
+   else                  std::snprintf(buf,sizeof(buf),"%.3f s",sec);
+   return buf;
+}
+
+static std::string format_rate(double value, const char* unit)
+{
+   const char* prefix[] = { "", "k", "M", "G", "T" };
+   size_t ip = 0;
+   while(value >= 1000.0 && ip<4) { value /= 1000.0; ip++; }
+   char buf[32];
+   std::snprintf(buf,sizeof(buf),"%.2f %s%s/s",value,prefix[ip],unit);
+   return buf;
+}
+
+void micro_bench::run_one(bench_entry* entry, int64_t arg, bool has_arg, double min_time)
+{
+   std::string name = entry->name();
+   if(has_arg) name += "/" + std::to_string(arg);
+
+   // grow the number of iterations until the run takes at least min_time.
+   // The estimate is based on the previous run, with some margin
+   size_t iterations = 1;
+   while(true) {
+      bench_state state(arg,iterations);
+      entry->function()(state);
+
+      double elapsed = state.elapsed();
+      if(elapsed >= min_time || iterations >= 1000000000) {
+
+         std::string rate;
+         if(state.bytes() > 0)      rate = format_rate(state.bytes()/elapsed,"B");
+         else if(state.items() > 0) rate = format_rate(state.items()/elapsed,"items");
+
+         std::printf("%-44s %14s %12zu %16s %s\n",name.c_str(),format_time(elapsed/iterations).c_str(),iterations,rate.c_str(),state.label().c_str());
+         std::fflush(stdout);
+         return;
+      }
+
+      size_t next = (elapsed > 0.0)? static_cast<size_t>(1.4*iterations*min_time/elapsed) : 10*iterations;
+      if(next > 10*iterations) next = 10*iterations;
+      if(next <= iterations)   next = iterations+1;
+      iterations = next;
+   }
+}
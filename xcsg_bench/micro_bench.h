@@ -0,0 +1,166 @@
+// BeginLicense:
+// Part of: xcsg - XML based Constructive Solid Geometry
+// Copyright (C) 2017-2020 Carsten Arnholm
+// All rights reserved
+//
+// This file may be used under the terms of either the GNU General
+// Public License version 2 or 3 (at your option) as published by the
+// Free Software Foundation and appearing in the files LICENSE.GPL2
+// and LICENSE.GPL3 included in the packaging of this file.
+//
+// This file is provided "AS IS" with NO WARRANTY OF ANY KIND,
+// INCLUDING THE WARRANTIES OF DESIGN, MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE. ALL COPIES OF THIS FILE MUST INCLUDE THIS LICENSE.
+// EndLicense:
+
+#ifndef MICRO_BENCH_H
+#define MICRO_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// micro_bench is a small benchmark harness in the style of Google Benchmark.
+// A benchmark is a function taking a bench_state, where the timed code is
+// placed inside a range based for loop over the state:
+//
+//   static void bm_make_cone(bench_state& state)
+//   {
+//      for(auto _ : state) {
+//         primitives3d::make_cone(10,5,20,false,state.arg());
+//      }
+//      state.set_items_processed(state.iterations());
+//   }
+//   MICRO_BENCH(bm_make_cone)->range(8,512);
+//
+// The harness repeats each benchmark with an increasing number of iterations
+// until the minimum time is reached, and reports the time per iteration.
+
+class bench_state {
+public:
+   bench_state(int64_t arg, size_t iterations);
+
+   // the current argument, see bench_entry::arg and bench_entry::range
+   int64_t arg() const { return m_arg; }
+
+   // number of iterations in this run
+   size_t iterations() const { return m_iterations; }
+
+   // exclude setup code inside the loop from timing
+   void pause_timing();
+   void resume_timing();
+
+   // optional rate reporting, items or bytes per second
+   void set_items_processed(size_t items) { m_items = items; }
+   void set_bytes_processed(size_t bytes) { m_bytes = bytes; }
+
+   // optional text shown with the result
+   void set_label(const std::string& label) { m_label = label; }
+
+   // seconds of timed execution
+   double elapsed() const { return m_elapsed; }
+   size_t items() const   { return m_items; }
+   size_t bytes() const   { return m_bytes; }
+   const std::string& label() const { return m_label; }
+
+   // loop variable type of "for(auto _ : state)", marked unused so the loop compiles without warnings
+#if defined(__GNUC__)
+   struct __attribute__((unused)) value {};
+#else
+   struct value {};
+#endif
+
+   // iteration support for "for(auto _ : state)"
+   class iterator {
+   public:
+      iterator(bench_state* state, size_t remaining) : m_state(state), m_remaining(remaining) {}
+      bool operator!=(const iterator&) const;
+      iterator& operator++() { --m_remaining; return *this; }
+      value operator*() const { return value(); }
+   private:
+      bench_state* m_state;
+      size_t       m_remaining;
+   };
+   iterator begin();
+   iterator end() { return iterator(this,0); }
+
+private:
+   void start();
+   void stop();
+
+private:
+   typedef std::chrono::steady_clock clock;
+
+   int64_t           m_arg;
+   size_t            m_iterations;
+   size_t            m_items;
+   size_t            m_bytes;
+   std::string       m_label;
+   double            m_elapsed;
+   clock::time_point m_start;
+   bool              m_running;
+};
+
+typedef void (*bench_function)(bench_state&);
+
+// a registered benchmark, with the list of arguments to run it for
+class bench_entry {
+public:
+   bench_entry(const std::string& name, bench_function func);
+
+   // run the benchmark with the given argument
+   bench_entry* arg(int64_t value);
+
+   // run the benchmark for arguments lo, lo*mult, lo*mult^2 ... up to and including hi
+   bench_entry* range(int64_t lo, int64_t hi, int64_t mult=8);
+
+   const std::string& name() const          { return m_name; }
+   bench_function function() const          { return m_func; }
+   const std::vector<int64_t>& args() const { return m_args; }
+
+private:
+   std::string          m_name;
+   bench_function       m_func;
+   std::vector<int64_t> m_args;
+};
+
+class micro_bench {
+public:
+   static micro_bench& singleton()  { static micro_bench instance; return instance;  }
+
+   // register a benchmark, called via MICRO_BENCH
+   bench_entry* add(const std::string& name, bench_function func);
+
+   // run all benchmarks with names containing filter (empty means all).
+   // Each benchmark runs for at least min_time seconds
+   size_t run(const std::string& filter, double min_time);
+
+protected:
+   micro_bench();
+   virtual ~micro_bench();
+
+   // run a single benchmark and print the result line
+   void run_one(bench_entry* entry, int64_t arg, bool has_arg, double min_time);
+
+private:
+   std::vector<bench_entry*> m_entries;
+};
+
+// prevent the compiler from optimizing away a computed value
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+   asm volatile("" : : "r,m"(value) : "memory");
+#else
+   static volatile const void* sink;
+   sink = &value;
+#endif
+}
+
+#define MICRO_BENCH_CONCAT2(a,b) a##b
+#define MICRO_BENCH_CONCAT(a,b) MICRO_BENCH_CONCAT2(a,b)
+#define MICRO_BENCH(func) static bench_entry* MICRO_BENCH_CONCAT(micro_bench_entry_,__LINE__) = micro_bench::singleton().add(#func,func)
+
+#endif // MICRO_BENCH_H